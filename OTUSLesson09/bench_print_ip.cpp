@@ -0,0 +1,67 @@
+/**@file
+    @brief benchmark of print_ip (ostream) vs format_ips (char buffer)
+*/
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include "print_ip.h"
+#include "format_ip.h"
+
+using namespace std;
+
+template <typename F>
+double measure(F f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+template <typename T>
+void bench(const string& name, const vector<T>& ips) {
+    stringstream out;
+    double ostream_time = measure([&]{
+        for (const auto& ip : ips) {
+            print_ip(ip, out);
+        }
+    });
+    vector<char> buffer;
+    double buffer_time = measure([&]{
+        format_ips(ips.begin(), ips.end(), buffer);
+    });
+    if (out.str().size() != buffer.size()) {
+        cerr << name << ": outputs differ\n";
+    }
+    auto mips = static_cast<double>(ips.size()) / 1e6;
+    cout << name << "\tprint_ip: " << mips / ostream_time << " M/s"
+         << "\tformat_ips: " << mips / buffer_time << " M/s\n";
+}
+
+int main() {
+    constexpr size_t N = 1'000'000;
+    mt19937 gen(42);
+    uniform_int_distribution<unsigned> dist;
+
+    vector<unsigned> ints(N);
+    for (auto& ip : ints) ip = dist(gen);
+    bench("uint32", ints);
+
+    vector<vector<unsigned char>> conts(N);
+    for (auto& ip : conts) {
+        auto v = dist(gen);
+        ip = {static_cast<unsigned char>(v >> 24), static_cast<unsigned char>(v >> 16),
+              static_cast<unsigned char>(v >> 8), static_cast<unsigned char>(v)};
+    }
+    bench("vector", conts);
+
+    vector<tuple<int, int, int, int>> tuples(N);
+    for (auto& ip : tuples) {
+        auto v = dist(gen);
+        ip = make_tuple(v >> 24, v >> 16 & 0xff, v >> 8 & 0xff, v & 0xff);
+    }
+    bench("tuple", tuples);
+    return 0;
+}
@@ -0,0 +1,299 @@
+#pragma once
+/**@file
+    @brief format_ip_to functions for rendering ip-addresses into char buffers
+
+    Non-allocating counterpart of print_ip: ip-address is rendered into
+    the caller-provided buffer [first, last) with the same rules as print_ip,
+    but without trailing '\n'. Functions have std::to_chars-like interface:
+    returned ptr points past the last written char, ec is std::errc::value_too_large
+    if buffer is too small (buffer content is unspecified in this case).
+    It can format ip-address represented by
+    - any integer type (constexpr)
+    - std::string
+    - std::vector, std::list with any integer types
+    - tuple with any integer types
+
+    format_ip / parse_ip are constexpr versions for compile-time ip-address literals:
+    format_ip returns null-terminated std::array<char, N> with N computed from the type.
+*/
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "meta_utils.h"
+
+namespace ip_format_detail {
+
+/// max length of one octet "255"
+constexpr std::size_t kMaxOctetLength = 3;
+
+/// writes one octet [0..255] to out without bounds checking, returns pointer past the end
+constexpr char* write_octet(char* out, unsigned char octet) {
+    if (octet >= 100) {
+        *out++ = static_cast<char>('0' + octet / 100);
+    }
+    if (octet >= 10) {
+        *out++ = static_cast<char>('0' + octet / 10 % 10);
+    }
+    *out++ = static_cast<char>('0' + octet % 10);
+    return out;
+}
+
+/// unsigned type of the same size, make_unsigned_t<bool> is ill-formed
+template <typename T>
+struct octets_type {using type = std::make_unsigned_t<T>;};
+template <>
+struct octets_type<bool> {using type = unsigned char;};
+
+/// gets idx octet of integer ip-address (0 is the most significant byte)
+template <typename T>
+constexpr unsigned char get_octet(T ip_address, std::size_t idx) {
+    using U = typename octets_type<T>::type;
+    auto shift = 8 * (sizeof(T) - 1 - idx);
+    return static_cast<unsigned char>((static_cast<U>(ip_address) >> shift) & 0xffu);
+}
+
+/// constexpr analog of std::to_chars for int (to_chars isn't constexpr in c++17)
+constexpr char* write_int(char* out, int value) {
+    unsigned u = value < 0 ? 0u - static_cast<unsigned>(value) : static_cast<unsigned>(value);
+    if (value < 0) {
+        *out++ = '-';
+    }
+    char digits[10] = {};
+    int n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + u % 10);
+        u /= 10;
+    } while (u != 0);
+    while (n != 0) {
+        *out++ = digits[--n];
+    }
+    return out;
+}
+
+/// max length of int text representation "-2147483648"
+constexpr std::size_t kMaxIntLength = 11;
+
+/// writes integer element of container or tuple as number, like print_ip does
+template <typename T>
+std::to_chars_result write_number(char* first, char* last, T value) {
+    static_assert(std::is_integral_v<T>);
+    return std::to_chars(first, last, static_cast<int>(value));
+}
+
+template <typename Tuple, std::size_t... Is>
+std::to_chars_result write_tuple(char* first, char* last, const Tuple& ip_address,
+        std::index_sequence<Is...>)
+{
+    std::to_chars_result res{first, std::errc()};
+    auto write_elem = [&res, last](std::size_t idx, auto value) {
+        if (res.ec != std::errc()) return;
+        if (idx != 0) {
+            if (res.ptr == last) {
+                res.ec = std::errc::value_too_large;
+                return;
+            }
+            *res.ptr++ = '.';
+        }
+        res = write_number(res.ptr, last, value);
+    };
+    (write_elem(Is, std::get<Is>(ip_address)), ...);
+    return res;
+}
+
+template <typename Tuple, std::size_t... Is>
+constexpr char* write_tuple_ints(char* out, const Tuple& ip_address, std::index_sequence<Is...>) {
+    auto write_elem = [&out](std::size_t idx, int value) {
+        if (idx != 0) {
+            *out++ = '.';
+        }
+        out = write_int(out, value);
+    };
+    (write_elem(Is, static_cast<int>(std::get<Is>(ip_address))), ...);
+    return out;
+}
+
+} // namespace ip_format_detail
+
+/// max length of integer type ip-address text representation
+template <typename T>
+constexpr std::size_t max_ip_length() {
+    return sizeof(T) * (ip_format_detail::kMaxOctetLength + 1) - 1;
+}
+
+/**
+    @brief format_ip_to for integer types
+
+    formats integer type ip-address like byte-array (most significant byte first) with '.' as separator
+    e.g. short(0) -> 0.0
+    @param first, last -- output buffer
+    @param ip_address -- ip-address as any integer type
+*/
+template <typename T>
+constexpr std::enable_if_t<std::is_integral_v<T>, std::to_chars_result>
+        format_ip_to(char* first, char* last, T ip_address) {
+    if (last - first < static_cast<std::ptrdiff_t>(max_ip_length<T>())) {
+        return {last, std::errc::value_too_large};
+    }
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        if (i != 0) {
+            *first++ = '.';
+        }
+        first = ip_format_detail::write_octet(first, ip_format_detail::get_octet(ip_address, i));
+    }
+    return {first, std::errc()};
+}
+
+/**
+    @brief format_ip_to for std::string (copies as is)
+*/
+inline std::to_chars_result format_ip_to(char* first, char* last, std::string_view ip_address) {
+    if (static_cast<std::size_t>(last - first) < ip_address.size()) {
+        return {last, std::errc::value_too_large};
+    }
+    return {ip_address.copy(first, ip_address.size()) + first, std::errc()};
+}
+
+inline std::to_chars_result format_ip_to(char* first, char* last, const std::string& ip_address) {
+    return format_ip_to(first, last, std::string_view(ip_address));
+}
+
+/**
+    @brief format_ip_to for std::vector and std::list types
+
+    integer elements are formatted as is with '.' as separator:
+    e.g. vector<int>{127,0,0,1} -> 127.0.0.1
+*/
+template <typename T>
+std::enable_if_t<is_cont<T>::value, std::to_chars_result>
+        format_ip_to(char* first, char* last, const T& ip_address) {
+    static_assert(std::is_integral_v<typename T::value_type>);
+    std::to_chars_result res{first, std::errc()};
+    bool is_first = true;
+    for (auto c : ip_address) {
+        if (is_first) {
+            is_first = false;
+        } else {
+            if (res.ptr == last) return {last, std::errc::value_too_large};
+            *res.ptr++ = '.';
+        }
+        res = ip_format_detail::write_number(res.ptr, last, c);
+        if (res.ec != std::errc()) return res;
+    }
+    return res;
+}
+
+/**
+    @brief format_ip_to for std::tuple
+
+    tuple can have only the same integer types, they are formatted as is with '.' as separator
+*/
+template <typename ... Types>
+std::to_chars_result format_ip_to(char* first, char* last, const std::tuple<Types...>& ip_address) {
+    static_assert(is_all_of<Types...>::value);
+    return ip_format_detail::write_tuple(first, last, ip_address,
+            std::index_sequence_for<Types...>{});
+}
+
+/**
+    @brief batch formatting: appends all ip-addresses from [first, last) to buffer, each followed by '\n'
+
+    buffer grows geometrically, so formatting of N addresses makes O(logN) allocations
+    (and no allocations at all if buffer has enough capacity)
+    @return number of appended chars
+*/
+template <typename It>
+std::size_t format_ips(It first, It last, std::vector<char>& buffer) {
+    constexpr std::size_t kMinReserve = 64;
+    auto start_size = buffer.size();
+    auto used = start_size;
+    for (; first != last; ++first) {
+        for (;;) {
+            if (buffer.size() - used < kMinReserve) {
+                buffer.resize(std::max(buffer.size() * 2, buffer.size() + kMinReserve));
+            }
+            auto* begin = buffer.data() + used;
+            auto* end = buffer.data() + buffer.size();
+            auto res = format_ip_to(begin, end, *first);
+            if (res.ec == std::errc() && res.ptr != end) {
+                *res.ptr++ = '\n';
+                used = static_cast<std::size_t>(res.ptr - buffer.data());
+                break;
+            }
+            buffer.resize(buffer.size() * 2);
+        }
+    }
+    buffer.resize(used);
+    return used - start_size;
+}
+
+/**
+    @brief constexpr format_ip for integer types
+
+    @return null-terminated char array, e.g. format_ip(2130706433).data() -> "127.0.0.1"
+*/
+template <typename T>
+constexpr std::enable_if_t<std::is_integral_v<T>, std::array<char, max_ip_length<T>() + 1>>
+        format_ip(T ip_address) {
+    std::array<char, max_ip_length<T>() + 1> res{};
+    format_ip_to(res.data(), res.data() + res.size(), ip_address);
+    return res;
+}
+
+/**
+    @brief constexpr format_ip for std::tuple
+
+    tuple can have only the same integer types, they are formatted as int with '.' as separator
+    @return null-terminated char array
+*/
+template <typename ... Types>
+constexpr std::array<char, sizeof...(Types) * (ip_format_detail::kMaxIntLength + 1)>
+        format_ip(const std::tuple<Types...>& ip_address) {
+    static_assert(is_all_of<Types...>::value);
+    std::array<char, sizeof...(Types) * (ip_format_detail::kMaxIntLength + 1)> res{};
+    ip_format_detail::write_tuple_ints(res.data(), ip_address, std::index_sequence_for<Types...>{});
+    return res;
+}
+
+/**
+    @brief constexpr parse_ip for integer types
+
+    parses exactly sizeof(T) decimal octets [0..255] separated by '.' (most significant byte first),
+    so parse_ip<T>(format_ip(ip).data()) == ip
+    @return parsed ip-address or std::nullopt if string has wrong format
+*/
+template <typename T>
+constexpr std::enable_if_t<std::is_integral_v<T>, std::optional<T>>
+        parse_ip(std::string_view str) {
+    using U = std::make_unsigned_t<T>;
+    U res = 0;
+    std::size_t pos = 0;
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        if (i != 0) {
+            if (pos == str.size() || str[pos] != '.') return std::nullopt;
+            ++pos;
+        }
+        unsigned octet = 0;
+        std::size_t digits = 0;
+        while (pos < str.size() && str[pos] >= '0' && str[pos] <= '9' && digits < 3) {
+            octet = octet * 10 + static_cast<unsigned>(str[pos] - '0');
+            ++pos;
+            ++digits;
+        }
+        if (digits == 0 || octet > 255) return std::nullopt;
+        res = static_cast<U>((res << 8) | octet);
+    }
+    if (pos != str.size()) return std::nullopt;
+    return static_cast<T>(res);
+}
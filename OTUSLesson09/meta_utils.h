@@ -1,5 +1,7 @@
 #pragma once
+#include <list>
 #include <type_traits>
+#include <vector>
 
 /// checks if type is container
 template <typename T>
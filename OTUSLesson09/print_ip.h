@@ -8,14 +8,19 @@
     - std::string (prints as is)
     - std::vector, std::list with any integer types
     - tuple with any integer types
+    Text is rendered into a stack buffer (see format_ip.h) and written to the stream at once,
+    long containers are written by chunks.
 */
 
+#include <array>
 #include <iostream>
 #include <type_traits>
 #include <string>
 #include <tuple>
+#include <vector>
 
 #include "meta_utils.h"
+#include "format_ip.h"
 
 /**
     @brief print_ip for std::string
@@ -37,19 +42,10 @@ void print_ip(const std::string& ip_address, std::ostream& out) {
 */
 template <typename T>
 std::enable_if_t<std::is_integral_v<T>, void> print_ip(T ip_address, std::ostream& out) {
-    auto p = reinterpret_cast<unsigned char*>(&ip_address);
-    auto i = p + sizeof(T);
-    bool is_first = true;
-    while (i != p) {
-        --i;
-        if (is_first) {
-            is_first = false;
-        } else {
-            out << '.';
-        }
-        out << int(*i);
-    }
-    out << '\n';
+    std::array<char, max_ip_length<T>() + 1> buffer{};
+    auto res = format_ip_to(buffer.data(), buffer.data() + buffer.size(), ip_address);
+    *res.ptr++ = '\n';
+    out.write(buffer.data(), res.ptr - buffer.data());
 }
 
 /**
@@ -64,38 +60,34 @@ std::enable_if_t<std::is_integral_v<T>, void> print_ip(T ip_address, std::ostrea
 */
 template <typename T>
 std::enable_if_t<is_cont<T>::value, void>
-        print_ip(T ip_address, std::ostream& out) {
+        print_ip(const T& ip_address, std::ostream& out) {
     static_assert(std::is_integral_v<typename T::value_type>);
+    // the longest int element plus '.' or '\n'
+    constexpr std::size_t max_elem_length = ip_format_detail::kMaxIntLength + 1;
+    // long containers are written by chunks
+    std::array<char, 16 * max_elem_length> buffer{};
+    char* p = buffer.data();
+    auto flush_if_full = [&out, &buffer, &p]() {
+        if (static_cast<std::size_t>(buffer.data() + buffer.size() - p) < max_elem_length) {
+            out.write(buffer.data(), p - buffer.data());
+            p = buffer.data();
+        }
+    };
     bool is_first = true;
     for (auto c : ip_address) {
+        flush_if_full();
         if (is_first) {
             is_first = false;
         } else {
-            out << '.';
+            *p++ = '.';
         }
-        out << int(c);
+        p = ip_format_detail::write_number(p, buffer.data() + buffer.size(), c).ptr;
     }
-    out << '\n';
+    flush_if_full();
+    *p++ = '\n';
+    out.write(buffer.data(), p - buffer.data());
 }
 
-template <typename Tuple, std::size_t first, std::size_t last>
-struct tuple_printer {
-    static void print(const Tuple &ip_address, std::ostream &out) {
-        if constexpr (first) {
-            out << '.';
-        }
-        out << int(std::get<first>(ip_address));
-        tuple_printer<Tuple, first+1, last>::print(ip_address, out);
-    }
-};
-
-template <typename Tuple, std::size_t N>
-struct tuple_printer<Tuple, N, N> {
-    static void print(const Tuple &ip_address, std::ostream &out) {
-        out << '\n';
-    }
-};
-
 /**
     @brief print_ip for std::tuple
 
@@ -108,6 +100,10 @@ struct tuple_printer<Tuple, N, N> {
 template <typename ... Types>
 void print_ip(const std::tuple<Types...>& ip_address, std::ostream& out) {
     static_assert(is_all_of<Types...>::value);
-    tuple_printer<std::tuple<Types...>, 0u, sizeof...(Types)>::print(ip_address, out);
+    // "-2147483648" is the longest int element, plus '.' or '\n'
+    std::array<char, sizeof...(Types) * 12> buffer{};
+    auto res = format_ip_to(buffer.data(), buffer.data() + buffer.size(), ip_address);
+    *res.ptr++ = '\n';
+    out.write(buffer.data(), res.ptr - buffer.data());
 }
 
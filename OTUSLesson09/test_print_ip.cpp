@@ -6,8 +6,11 @@
 #include <list>
 #include <tuple>
 #include <sstream>
+#include <string_view>
+#include <cstdint>
 
 #include "print_ip.h"
+#include "format_ip.h"
 
 using namespace std;
 
@@ -34,6 +37,13 @@ BOOST_AUTO_TEST_SUITE(print_ip_test_suite)
             print_ip(8875824491850138409, res);
             BOOST_CHECK(res.str() == "123.45.67.89.101.112.131.41\n");
         }
+        {
+            // bool is one byte
+            stringstream res;
+            print_ip(true, res);
+            print_ip(false, res);
+            BOOST_CHECK(res.str() == "1\n0\n");
+        }
     }
 
     BOOST_AUTO_TEST_CASE(test_print_string) {
@@ -75,6 +85,17 @@ BOOST_AUTO_TEST_SUITE(print_ip_test_suite)
             print_ip(list<long long>{127, 0, 0, 1}, res);
             BOOST_CHECK(res.str() == "127.0.0.1\n");
         }
+        {
+            stringstream res;
+            vector<int> ip_address(100, -2147483647 - 1);
+            print_ip(ip_address, res);
+            string expected;
+            for (auto ip_part : ip_address) {
+                expected += to_string(ip_part) + '.';
+            }
+            expected.back() = '\n';
+            BOOST_CHECK(res.str() == expected);
+        }
 //        compilation error: static_assert -- not is_integral
 //        {
 //            stringstream res;
@@ -115,6 +136,96 @@ BOOST_AUTO_TEST_SUITE_END()
 
 
 
+BOOST_AUTO_TEST_SUITE(format_ip_test_suite)
+
+    template <typename T>
+    string format_to_string(const T& ip_address) {
+        char buffer[128];
+        auto res = format_ip_to(buffer, buffer + sizeof(buffer), ip_address);
+        BOOST_REQUIRE(res.ec == errc());
+        return string(buffer, res.ptr);
+    }
+
+    BOOST_AUTO_TEST_CASE(test_format_ip_to) {
+        BOOST_CHECK(format_to_string(char(-1)) == "255");
+        BOOST_CHECK(format_to_string(short(0)) == "0.0");
+        BOOST_CHECK(format_to_string(2130706433) == "127.0.0.1");
+        BOOST_CHECK(format_to_string(8875824491850138409) == "123.45.67.89.101.112.131.41");
+        BOOST_CHECK(format_to_string(string("127.0.0.1")) == "127.0.0.1");
+        BOOST_CHECK(format_to_string(vector<unsigned char>{}) == "");
+        BOOST_CHECK(format_to_string(vector<unsigned char>{127, 0, 0, 1}) == "127.0.0.1");
+        BOOST_CHECK(format_to_string(list<long long>{127, 0, 0, 1}) == "127.0.0.1");
+        BOOST_CHECK(format_to_string(make_tuple(127, 0, 0, 1)) == "127.0.0.1");
+    }
+
+    BOOST_AUTO_TEST_CASE(test_format_ip_to_small_buffer) {
+        char buffer[8];
+        BOOST_CHECK(format_ip_to(buffer, buffer + sizeof(buffer), 2130706433).ec == errc::value_too_large);
+        BOOST_CHECK(format_ip_to(buffer, buffer + sizeof(buffer), string("127.0.0.1")).ec == errc::value_too_large);
+        BOOST_CHECK(format_ip_to(buffer, buffer + sizeof(buffer), vector<int>{127, 0, 0, 1}).ec
+                    == errc::value_too_large);
+        BOOST_CHECK(format_ip_to(buffer, buffer + sizeof(buffer), make_tuple(127, 0, 0, 1)).ec
+                    == errc::value_too_large);
+        BOOST_CHECK(format_ip_to(buffer, buffer + sizeof(buffer), short(257)).ec == errc());
+    }
+
+    BOOST_AUTO_TEST_CASE(test_format_ips_batch) {
+        vector<int> ips(1000, 2130706433);
+        vector<char> buffer;
+        auto n = format_ips(ips.begin(), ips.end(), buffer);
+        BOOST_CHECK(n == 1000 * string("127.0.0.1\n").size());
+        BOOST_CHECK(buffer.size() == n);
+        BOOST_CHECK(string(buffer.begin(), buffer.begin() + 10) == "127.0.0.1\n");
+
+        vector<vector<int>> conts{{1, 2}, {3}};
+        format_ips(conts.begin(), conts.end(), buffer);
+        BOOST_CHECK(string(buffer.end() - 6, buffer.end()) == "1.2\n3\n");
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
+
+
+BOOST_AUTO_TEST_SUITE(constexpr_ip_test_suite)
+
+    constexpr bool equal(const char* lhs, const char* rhs) {
+        return string_view(lhs) == string_view(rhs);
+    }
+
+    // compile-time ip constants
+    constexpr uint32_t LOCALHOST = *parse_ip<uint32_t>("127.0.0.1");
+    constexpr uint32_t PRIVATE_NET = *parse_ip<uint32_t>("192.168.0.0");
+    constexpr auto LOCALHOST_STR = format_ip(LOCALHOST);
+
+    static_assert(LOCALHOST == 2130706433);
+    static_assert(PRIVATE_NET == 0xc0a80000);
+    static_assert(LOCALHOST_STR.size() == 16);
+    static_assert(equal(LOCALHOST_STR.data(), "127.0.0.1"));
+    static_assert(equal(format_ip(char(-1)).data(), "255"));
+    static_assert(equal(format_ip(short(0)).data(), "0.0"));
+    static_assert(equal(format_ip(true).data(), "1"));
+    static_assert(equal(format_ip(8875824491850138409).data(), "123.45.67.89.101.112.131.41"));
+    static_assert(equal(format_ip(make_tuple(127, 0, 0, 1)).data(), "127.0.0.1"));
+    static_assert(equal(format_ip(make_tuple(-1, 1000)).data(), "-1.1000"));
+    static_assert(format_ip(make_tuple(127, 0, 0, 1)).size() == 48);
+    static_assert(*parse_ip<long long>("123.45.67.89.101.112.131.41") == 8875824491850138409);
+    static_assert(*parse_ip<char>("255") == char(-1));
+    static_assert(!parse_ip<uint32_t>("127.0.0"));
+    static_assert(!parse_ip<uint32_t>("127.0.0.1.1"));
+    static_assert(!parse_ip<uint32_t>("127.0.0.256"));
+    static_assert(!parse_ip<uint32_t>("127.0..1"));
+    static_assert(!parse_ip<uint32_t>("127.0.0.1 "));
+
+    BOOST_AUTO_TEST_CASE(test_format_parse_roundtrip) {
+        for (uint32_t ip : {0u, 1u, 255u, 256u, 2130706433u, 0xffffffffu}) {
+            auto str = format_ip(ip);
+            BOOST_CHECK(parse_ip<uint32_t>(str.data()) == ip);
+        }
+        BOOST_CHECK(string(format_ip(make_tuple(char(127), char(0), char(0), char(1))).data()) == "127.0.0.1");
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
+
+
 BOOST_AUTO_TEST_SUITE(templates_test_suite)
 
     BOOST_AUTO_TEST_CASE(test_is_cont) {
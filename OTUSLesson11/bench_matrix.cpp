@@ -0,0 +1,67 @@
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "concurrent_sparse_matrix.h"
+#include "dok_sparse_matrix.h"
+
+using namespace std;
+
+namespace {
+
+constexpr std::size_t OPS_PER_THREAD = 20'000;
+constexpr std::size_t MATRIX_DIM = 10'000;
+
+template <typename F>
+double run_threads(std::size_t threads_count, F f) {
+    auto start = chrono::steady_clock::now();
+    vector<thread> threads;
+    threads.reserve(threads_count);
+    for (std::size_t t = 0; t < threads_count; ++t) {
+        threads.emplace_back(f, t);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main() {
+    cout << "threads\tsingle_mutex_Mops\tstriped_Mops\n";
+    for (std::size_t threads_count = 1; threads_count <= 64; threads_count *= 2) {
+        double total_ops = static_cast<double>(threads_count * OPS_PER_THREAD) / 1e6;
+
+        SparseMatrixDOK<long, 0> dok;
+        mutex dok_mtx;
+        double single_time = run_threads(threads_count, [&](std::size_t seed) {
+            mt19937_64 gen(seed);
+            uniform_int_distribution<std::size_t> dist(0, MATRIX_DIM);
+            for (std::size_t i = 0; i < OPS_PER_THREAD; ++i) {
+                auto row = dist(gen);
+                auto col = dist(gen);
+                lock_guard lk(dok_mtx);
+                dok[row][col] = dok[row][col] + 1;
+            }
+        });
+
+        ConcurrentSparseMatrixDOK<long, 0> cm;
+        double striped_time = run_threads(threads_count, [&](std::size_t seed) {
+            mt19937_64 gen(seed);
+            uniform_int_distribution<std::size_t> dist(0, MATRIX_DIM);
+            for (std::size_t i = 0; i < OPS_PER_THREAD; ++i) {
+                auto row = dist(gen);
+                auto col = dist(gen);
+                cm(row, col) += 1;
+            }
+        });
+
+        cout << threads_count << '\t' << total_ops / single_time
+             << '\t' << total_ops / striped_time << '\n';
+    }
+    return 0;
+}
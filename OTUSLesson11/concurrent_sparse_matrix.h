@@ -0,0 +1,140 @@
+#pragma once
+
+#include <array>
+#include <functional>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "dok_sparse_matrix.h"
+
+/**
+ * @brief Thread-safe sparse matrix with striped locking
+ *
+ * Data is split into ShardsCount shards by row, every shard is
+ * std::unordered_map<std::pair<row, col>, T> guarded by its own mutex,
+ * so writers to different row stripes don't contend.
+ * operator() / operator+= -- amortized O(1) under one shard lock
+ * snapshot() -- locks all shards (in fixed order) and copies data into SparseMatrixDOK
+ */
+template <typename T, T zero_value, std::size_t ShardsCount = 64>
+class ConcurrentSparseMatrixDOK {
+private:
+    static_assert(ShardsCount != 0);
+    using Index = std::pair<std::size_t, std::size_t>;
+
+    struct IndexHash {
+        std::size_t operator()(const Index& idx) const {
+            return std::hash<std::size_t>{}(idx.first * 0x9e3779b97f4a7c15ull ^ idx.second);
+        }
+    };
+
+    struct alignas(64) Shard {
+        mutable std::mutex mtx;
+        std::unordered_map<Index, T, IndexHash> data;
+    };
+
+    class ValueProxy {
+    public:
+        ValueProxy(ConcurrentSparseMatrixDOK& matrix, std::size_t row, std::size_t col)
+            : matrix_(matrix), row_(row), col_(col)
+        {}
+
+        ValueProxy& operator=(const ValueProxy& other) {
+            *this = static_cast<T>(other);
+            return *this;
+        }
+
+        ValueProxy& operator=(T value) {
+            matrix_.set_value(row_, col_, value);
+            return *this;
+        }
+
+        ValueProxy& operator+=(T value) {
+            matrix_.accumulate(row_, col_, value);
+            return *this;
+        }
+
+        operator T() const {
+            return std::as_const(matrix_)(row_, col_);
+        }
+    private:
+        ConcurrentSparseMatrixDOK& matrix_;
+        std::size_t row_ = 0;
+        std::size_t col_ = 0;
+    };
+
+public:
+    using Snapshot = SparseMatrixDOK<T, zero_value>;
+
+    [[nodiscard]] std::size_t size() const {
+        std::size_t res = 0;
+        for (const auto& shard : shards_) {
+            std::lock_guard lk(shard.mtx);
+            res += shard.data.size();
+        }
+        return res;
+    }
+
+    T operator()(std::size_t row, std::size_t col) const {
+        const auto& shard = get_shard(row);
+        std::lock_guard lk(shard.mtx);
+        if (auto it = shard.data.find({row, col}); it != shard.data.end()) {
+            return it->second;
+        }
+        return zero_value;
+    }
+
+    ValueProxy operator()(std::size_t row, std::size_t col) {
+        return ValueProxy(*this, row, col);
+    }
+
+    /// consistent copy of all shards, can be iterated with range for
+    Snapshot snapshot() const {
+        std::vector<std::unique_lock<std::mutex>> locks;
+        locks.reserve(ShardsCount);
+        for (const auto& shard : shards_) {
+            locks.emplace_back(shard.mtx);
+        }
+        Snapshot res;
+        for (const auto& shard : shards_) {
+            for (const auto& [idx, val] : shard.data) {
+                res[idx.first][idx.second] = val;
+            }
+        }
+        return res;
+    }
+
+private:
+    std::array<Shard, ShardsCount> shards_;
+
+    Shard& get_shard(std::size_t row) {
+        return shards_[row % ShardsCount];
+    }
+
+    const Shard& get_shard(std::size_t row) const {
+        return shards_[row % ShardsCount];
+    }
+
+    void set_value(std::size_t row, std::size_t col, T value) {
+        auto& shard = get_shard(row);
+        std::lock_guard lk(shard.mtx);
+        if (value != zero_value) {
+            shard.data[{row, col}] = value;
+        } else {
+            shard.data.erase({row, col});
+        }
+    }
+
+    void accumulate(std::size_t row, std::size_t col, T value) {
+        auto& shard = get_shard(row);
+        std::lock_guard lk(shard.mtx);
+        auto [it, inserted] = shard.data.try_emplace({row, col}, zero_value);
+        it->second += value;
+        if (it->second == zero_value) {
+            shard.data.erase(it);
+        }
+    }
+};
@@ -1,9 +1,12 @@
 #pragma once
 
 #include <map>
+#include <string>
 #include <tuple>
 #include <utility>
 
+#include "sparse_matrix_file.h"
+
 /**
  * @brief Sparse matrix with DOK implementation (Dictionary of keys)
  *
@@ -17,6 +20,10 @@
  * std::map<std::pair<std::size_t row, std::size_t col>, T value> as a data storage
  * operator[][] -- O(logN) (for std::map)
  * (if replace std::map -> std::unordered_map, complexity will be amortized O(1))
+ *
+ * save() writes the matrix into binary file (see sparse_matrix_file.h),
+ * the file can be mmap-ed with sparse_file::MappedSparseMatrix for read-only access
+ * or loaded back with load().
  */
 template <typename T, T zero_value>
 class SparseMatrixDOK {
@@ -110,6 +117,25 @@ public:
     Row operator[](std::size_t row) {return Row(*this, row);}
     Iterator begin() {return Iterator(data_.begin());}
     Iterator end() {return Iterator(data_.end());}
+
+    void save(const std::string& filename) const {
+        sparse_file::Writer<T> writer(filename);
+        for (const auto& [idx, val] : data_) {
+            writer.add(idx.first, idx.second, val);
+        }
+        writer.finish();
+    }
+
+    static SparseMatrixDOK load(const std::string& filename) {
+        auto mapped = sparse_file::MappedSparseMatrix<T, zero_value>::load(filename);
+        SparseMatrixDOK res;
+        auto hint = res.data_.end();
+        for (auto [row, col, val] : mapped) {
+            hint = res.data_.emplace_hint(hint, std::make_pair(row, col), val);
+            ++hint;
+        }
+        return res;
+    }
 private:
     MatrixData data_;
     static constexpr T zero_value_ = zero_value;
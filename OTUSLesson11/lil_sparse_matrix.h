@@ -2,8 +2,11 @@
 
 #include <list>
 #include <optional>
+#include <string>
 #include <tuple>
 
+#include "sparse_matrix_file.h"
+
 /**
  * @brief Sparse matrix with LIL implementation (List of lists)
  *
@@ -15,6 +18,9 @@
  * This sparse matrix implementation uses
  * std::list<{std::size_t row, std::list<{std::size_t col, T}>}> as a data storage
  * operator[][] -- O(N^2)
+ *
+ * save() writes the matrix into binary file (see sparse_matrix_file.h),
+ * load() reads it back.
  */
 template <typename T, T zero_value>
 class SparseMatrixLIL {
@@ -146,6 +152,30 @@ public:
         }
     }
     Iterator end() {return Iterator(data_.end(), std::nullopt, data_);}
+
+    void save(const std::string& filename) const {
+        sparse_file::Writer<T> writer(filename);
+        for (const auto& row_node : data_) {
+            for (const auto& col_node : row_node.column_) {
+                writer.add(row_node.row, col_node.col, col_node.val_);
+            }
+        }
+        writer.finish();
+    }
+
+    static SparseMatrixLIL load(const std::string& filename) {
+        auto mapped = sparse_file::MappedSparseMatrix<T, zero_value>::load(filename);
+        SparseMatrixLIL res;
+        // entries are sorted by (row, col), so they are appended to the back
+        for (auto [row, col, val] : mapped) {
+            if (res.data_.empty() || res.data_.back().row != row) {
+                res.data_.push_back({row});
+            }
+            res.data_.back().column_.push_back({col, val});
+            ++res.size_;
+        }
+        return res;
+    }
 private:
     MatrixData data_;
     static constexpr T zero_value_ = zero_value;
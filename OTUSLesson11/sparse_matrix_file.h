@@ -0,0 +1,361 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Binary file format for 2-dimensional sparse matrices
+ *
+ * File layout:
+ *   Header      -- magic, version, value size, entries count, block index position
+ *   Blocks      -- entries sorted by (row, col) and split into blocks of kBlockEntries:
+ *                  [varint row delta][varint col (delta if row is the same)][raw value]
+ *   BlockIndex  -- {first row, first col, block offset} for every block
+ *
+ * Block index gives binary search over blocks, then only one block is decoded,
+ * so lookup is O(logB + kBlockEntries) right over the mapped file.
+ */
+namespace sparse_file {
+
+constexpr std::uint32_t kMagic = 0x584d5053; // "SPMX"
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kBlockEntries = 64;
+
+struct Header {
+    std::uint32_t magic = kMagic;
+    std::uint32_t version = kVersion;
+    std::uint64_t value_size = 0;
+    std::uint64_t entries_count = 0;
+    std::uint64_t blocks_count = 0;
+    std::uint64_t index_offset = 0;
+};
+
+struct BlockIndexEntry {
+    std::uint64_t row = 0;
+    std::uint64_t col = 0;
+    std::uint64_t offset = 0;
+};
+
+inline void write_varint(std::vector<char>& buf, std::uint64_t value) {
+    while (value >= 0x80) {
+        buf.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    buf.push_back(static_cast<char>(value));
+}
+
+/// reads varint before end, throws on truncated or too long one (corrupted file)
+inline std::uint64_t read_varint(const char*& ptr, const char* end) {
+    std::uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (ptr == end) break;
+        auto byte = static_cast<unsigned char>(*ptr++);
+        value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+    throw std::runtime_error("bad sparse matrix block");
+}
+
+/**
+ * Streaming writer, entries must be added in (row, col) ascending order
+ */
+template <typename T>
+class Writer {
+    static_assert(std::is_trivially_copyable_v<T>);
+public:
+    explicit Writer(const std::string& filename)
+        : out_(filename, std::ios::binary | std::ios::trunc)
+    {
+        if (!out_) {
+            throw std::runtime_error("can't open file for writing: " + filename);
+        }
+        header_.value_size = sizeof(T);
+        write_raw(header_);
+        offset_ = sizeof(Header);
+    }
+
+    void add(std::size_t row, std::size_t col, const T& value) {
+        if (block_size_ == kBlockEntries) {
+            flush_block();
+        }
+        if (block_size_ == 0) {
+            index_.push_back({row, col, offset_ + block_.size()});
+            write_varint(block_, 0);
+            write_varint(block_, 0);
+        } else {
+            if (row < last_row_ || (row == last_row_ && col <= last_col_)) {
+                throw std::logic_error("sparse matrix entries must be sorted");
+            }
+            write_varint(block_, row - last_row_);
+            write_varint(block_, row == last_row_ ? col - last_col_ : col);
+        }
+        const auto* value_ptr = reinterpret_cast<const char*>(&value);
+        block_.insert(block_.end(), value_ptr, value_ptr + sizeof(T));
+        last_row_ = row;
+        last_col_ = col;
+        ++block_size_;
+        ++header_.entries_count;
+    }
+
+    void finish() {
+        flush_block();
+        header_.blocks_count = index_.size();
+        header_.index_offset = offset_;
+        for (const auto& entry : index_) {
+            write_raw(entry);
+        }
+        out_.seekp(0);
+        write_raw(header_);
+        out_.flush();
+        if (!out_) {
+            throw std::runtime_error("sparse matrix file write error");
+        }
+    }
+
+private:
+    std::ofstream out_;
+    Header header_;
+    std::vector<BlockIndexEntry> index_;
+    std::vector<char> block_;
+    std::size_t block_size_ = 0;
+    std::uint64_t offset_ = 0;
+    std::size_t last_row_ = 0;
+    std::size_t last_col_ = 0;
+
+    template <typename U>
+    void write_raw(const U& value) {
+        out_.write(reinterpret_cast<const char*>(&value), sizeof(U));
+    }
+
+    void flush_block() {
+        out_.write(block_.data(), static_cast<std::streamsize>(block_.size()));
+        offset_ += block_.size();
+        block_.clear();
+        block_size_ = 0;
+    }
+};
+
+/**
+ * Read-only sparse matrix which is served directly from the mmap-ed file
+ */
+template <typename T, T zero_value>
+class MappedSparseMatrix {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    class ConstRow {
+    public:
+        explicit ConstRow(const MappedSparseMatrix& matrix, std::size_t row)
+            : matrix_(matrix), row_(row) {}
+        T operator[](std::size_t col) const {
+            return matrix_.get_value_or_zero(row_, col);
+        }
+    private:
+        const MappedSparseMatrix& matrix_;
+        std::size_t row_ = 0;
+    };
+
+    class Iterator {
+    public:
+        Iterator(const MappedSparseMatrix& matrix, std::size_t block)
+            : matrix_(&matrix), block_(block)
+        {
+            start_block();
+        }
+        std::tuple<std::size_t, std::size_t, T> operator*() const {
+            return {row_, col_, value_};
+        }
+        friend bool operator==(const Iterator& lhs, const Iterator& rhs) {
+            return lhs.block_ == rhs.block_ && lhs.pos_ == rhs.pos_;
+        }
+        friend bool operator!=(const Iterator& lhs, const Iterator& rhs) {
+            return !(lhs == rhs);
+        }
+        Iterator& operator++() {
+            if (++pos_ == matrix_->block_entries(block_)) {
+                ++block_;
+                start_block();
+            } else {
+                decode_next();
+            }
+            return *this;
+        }
+        const Iterator operator++(int) {
+            Iterator res = *this;
+            ++(*this);
+            return res;
+        }
+    private:
+        const MappedSparseMatrix* matrix_;
+        std::size_t block_ = 0;
+        std::size_t pos_ = 0;
+        const char* ptr_ = nullptr;
+        const char* end_ = nullptr;
+        std::size_t row_ = 0;
+        std::size_t col_ = 0;
+        T value_ = zero_value;
+
+        void start_block() {
+            pos_ = 0;
+            if (block_ >= matrix_->header_.blocks_count) {
+                block_ = matrix_->header_.blocks_count;
+                return;
+            }
+            const auto& entry = matrix_->block_index(block_);
+            std::tie(ptr_, end_) = matrix_->block_data(block_);
+            row_ = entry.row;
+            col_ = entry.col;
+            decode_next();
+        }
+
+        void decode_next() {
+            std::tie(row_, col_, value_) = matrix_->decode(ptr_, end_, row_, col_);
+        }
+    };
+
+public:
+    MappedSparseMatrix(const MappedSparseMatrix&) = delete;
+    MappedSparseMatrix& operator=(const MappedSparseMatrix&) = delete;
+    MappedSparseMatrix(MappedSparseMatrix&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)),
+          file_size_(std::exchange(other.file_size_, 0)),
+          header_(other.header_)
+    {}
+    ~MappedSparseMatrix() {
+        if (data_) {
+            munmap(const_cast<char*>(data_), file_size_);
+        }
+    }
+
+    static MappedSparseMatrix load(const std::string& filename) {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("can't open file: " + filename);
+        }
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(Header)) {
+            ::close(fd);
+            throw std::runtime_error("bad sparse matrix file: " + filename);
+        }
+        auto file_size = static_cast<std::size_t>(st.st_size);
+        void* addr = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            throw std::runtime_error("can't mmap file: " + filename);
+        }
+        return MappedSparseMatrix(static_cast<const char*>(addr), file_size);
+    }
+
+    [[nodiscard]] std::size_t size() const {return header_.entries_count;}
+    ConstRow operator[](std::size_t row) const {return ConstRow(*this, row);}
+    Iterator begin() const {return Iterator(*this, 0);}
+    Iterator end() const {return Iterator(*this, header_.blocks_count);}
+
+private:
+    const char* data_ = nullptr;
+    std::size_t file_size_ = 0;
+    Header header_;
+
+    MappedSparseMatrix(const char* data, std::size_t file_size)
+        : data_(data), file_size_(file_size)
+    {
+        std::memcpy(&header_, data_, sizeof(Header));
+        if (header_.magic != kMagic || header_.version != kVersion
+            || header_.value_size != sizeof(T)
+            || header_.index_offset < sizeof(Header) || header_.index_offset > file_size_
+            || header_.blocks_count > (file_size_ - header_.index_offset) / sizeof(BlockIndexEntry)
+            || header_.blocks_count != header_.entries_count / kBlockEntries
+                                       + (header_.entries_count % kBlockEntries != 0))
+        {
+            munmap(const_cast<char*>(data_), file_size_);
+            throw std::runtime_error("bad sparse matrix file header");
+        }
+    }
+
+    BlockIndexEntry block_index(std::size_t block) const {
+        BlockIndexEntry entry;
+        std::memcpy(&entry, data_ + header_.index_offset + block * sizeof(BlockIndexEntry),
+                sizeof(BlockIndexEntry));
+        return entry;
+    }
+
+    std::size_t block_entries(std::size_t block) const {
+        if (block + 1 < header_.blocks_count) return kBlockEntries;
+        return header_.entries_count - block * kBlockEntries;
+    }
+
+    /**
+     * Block data [begin, end), it ends at the next block or the index.
+     * Offsets are checked here, when the block is accessed, not on load,
+     * so opening a big file doesn't touch the whole index.
+     */
+    std::pair<const char*, const char*> block_data(std::size_t block) const {
+        auto begin = block_index(block).offset;
+        auto end = block + 1 < header_.blocks_count ? block_index(block + 1).offset : header_.index_offset;
+        if (begin < sizeof(Header) || (block == 0 && begin != sizeof(Header))
+            || begin >= end || end > header_.index_offset)
+        {
+            throw std::runtime_error("bad sparse matrix block");
+        }
+        return {data_ + begin, data_ + end};
+    }
+
+    std::tuple<std::size_t, std::size_t, T> decode(const char*& ptr, const char* end,
+            std::size_t prev_row, std::size_t prev_col) const
+    {
+        auto row_delta = read_varint(ptr, end);
+        auto col = read_varint(ptr, end);
+        if (static_cast<std::size_t>(end - ptr) < sizeof(T)) {
+            throw std::runtime_error("bad sparse matrix block");
+        }
+        T value;
+        std::memcpy(&value, ptr, sizeof(T));
+        ptr += sizeof(T);
+        if (row_delta == 0) {
+            return {prev_row, prev_col + col, value};
+        }
+        return {prev_row + row_delta, col, value};
+    }
+
+    T get_value_or_zero(std::size_t row, std::size_t col) const {
+        // find the last block which starts not after (row, col)
+        std::size_t lo = 0;
+        std::size_t hi = header_.blocks_count;
+        while (lo < hi) {
+            auto mid = lo + (hi - lo) / 2;
+            auto entry = block_index(mid);
+            if (std::tie(entry.row, entry.col) <= std::tie(row, col)) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (lo == 0) return zero_value;
+        auto block = lo - 1;
+        auto entry = block_index(block);
+        auto [ptr, end] = block_data(block);
+        std::size_t cur_row = entry.row;
+        std::size_t cur_col = entry.col;
+        for (std::size_t i = 0, n = block_entries(block); i < n; ++i) {
+            T value;
+            std::tie(cur_row, cur_col, value) = decode(ptr, end, cur_row, cur_col);
+            if (std::tie(cur_row, cur_col) == std::tie(row, col)) return value;
+            if (std::tie(cur_row, cur_col) > std::tie(row, col)) break;
+        }
+        return zero_value;
+    }
+};
+
+} // namespace sparse_file
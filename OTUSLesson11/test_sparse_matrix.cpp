@@ -1,11 +1,17 @@
 #define BOOST_TEST_MODULE allocator_test_module
 #include <boost/test/unit_test.hpp>
 
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
 #include <numeric>
+#include <thread>
+#include <vector>
 
 #include "dok_sparse_matrix.h"
 #include "lil_sparse_matrix.h"
 #include "multidimensional_sparse_matrix.h"
+#include "concurrent_sparse_matrix.h"
 
 using namespace std;
 
@@ -422,4 +428,172 @@ BOOST_AUTO_TEST_SUITE(MultiDOK_matrix_test_suite)
         BOOST_CHECK(m[150][150] == ZERO_VALUE);
     }
 
-BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE(Matrix_file_test_suite)
+
+    BOOST_AUTO_TEST_CASE(test_save_n_mapped_lookup) {
+        constexpr int ZERO_VALUE = -1;
+        const string filename = "test_matrix_save.bin";
+        SparseMatrixDOK<int, ZERO_VALUE> m;
+        for (int i = 0; i < 1000; ++i) {
+            m[i][i] = i;
+            m[i][1000 + 3*i] = -i;
+        }
+        m.save(filename);
+
+        auto mapped = sparse_file::MappedSparseMatrix<int, ZERO_VALUE>::load(filename);
+        BOOST_CHECK(mapped.size() == m.size());
+        for (int i = 0; i < 1000; ++i) {
+            BOOST_CHECK(mapped[i][i] == i);
+            BOOST_CHECK(mapped[i][1000 + 3*i] == -i);
+            BOOST_CHECK(mapped[i][i+1] == ZERO_VALUE);
+        }
+        BOOST_CHECK(mapped[5000][5000] == ZERO_VALUE);
+        std::size_t count = 0;
+        for (auto [row, col, val] : mapped) {
+            BOOST_CHECK(m[row][col] == val);
+            ++count;
+        }
+        BOOST_CHECK(count == m.size());
+        std::remove(filename.c_str());
+    }
+
+    BOOST_AUTO_TEST_CASE(test_save_load) {
+        constexpr int ZERO_VALUE = 0;
+        const string filename = "test_matrix_load.bin";
+        SparseMatrixLIL<int, ZERO_VALUE> lil;
+        lil[100][100] = 314;
+        lil[150][200] = 159;
+        lil[150][150] = 100;
+        lil.save(filename);
+
+        auto m = SparseMatrixDOK<int, ZERO_VALUE>::load(filename);
+        BOOST_CHECK(m.size() == 3);
+        BOOST_CHECK(m[100][100] == 314);
+        BOOST_CHECK(m[150][200] == 159);
+        BOOST_CHECK(m[150][150] == 100);
+        BOOST_CHECK(m[1][1] == ZERO_VALUE);
+
+        auto lil_loaded = SparseMatrixLIL<int, ZERO_VALUE>::load(filename);
+        BOOST_CHECK(lil_loaded.size() == 3);
+        BOOST_CHECK(lil_loaded[100][100] == 314);
+        BOOST_CHECK(lil_loaded[150][200] == 159);
+        BOOST_CHECK(lil_loaded[150][150] == 100);
+        BOOST_CHECK(lil_loaded[1][1] == ZERO_VALUE);
+        lil_loaded[150][170] = 7;
+        BOOST_CHECK(lil_loaded.size() == 4);
+        BOOST_CHECK(lil_loaded[150][170] == 7);
+        std::remove(filename.c_str());
+    }
+
+    BOOST_AUTO_TEST_CASE(test_empty_matrix) {
+        const string filename = "test_matrix_empty.bin";
+        SparseMatrixDOK<int, -1> m;
+        m.save(filename);
+        auto mapped = sparse_file::MappedSparseMatrix<int, -1>::load(filename);
+        BOOST_CHECK(mapped.size() == 0);
+        BOOST_CHECK(mapped.begin() == mapped.end());
+        BOOST_CHECK(mapped[0][0] == -1);
+        std::remove(filename.c_str());
+    }
+
+    BOOST_AUTO_TEST_CASE(test_corrupted_file) {
+        const string filename = "test_matrix_corrupted.bin";
+        using Mapped = sparse_file::MappedSparseMatrix<int, -1>;
+        // patches one 64-bit field of a valid file of 100 entries (2 blocks)
+        auto save_patched = [&filename](std::size_t pos, std::uint64_t value) {
+            SparseMatrixDOK<int, -1> m;
+            for (int i = 0; i < 100; ++i) {
+                m[i][i] = i;
+            }
+            m.save(filename);
+            fstream f(filename, ios::binary | ios::in | ios::out);
+            f.seekp(static_cast<std::streamoff>(pos));
+            f.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        };
+        save_patched(offsetof(sparse_file::Header, entries_count), 100);
+        BOOST_CHECK(Mapped::load(filename).size() == 100u);
+        sparse_file::Header header;
+        {
+            ifstream in(filename, ios::binary);
+            in.read(reinterpret_cast<char*>(&header), sizeof(header));
+        }
+        BOOST_REQUIRE(header.blocks_count == 2u);
+
+        // entries don't match blocks
+        save_patched(offsetof(sparse_file::Header, entries_count), 1000);
+        BOOST_CHECK_THROW(Mapped::load(filename), std::runtime_error);
+        // index size overflows
+        save_patched(offsetof(sparse_file::Header, blocks_count), std::uint64_t(1) << 60);
+        BOOST_CHECK_THROW(Mapped::load(filename), std::runtime_error);
+        // index outside the file
+        save_patched(offsetof(sparse_file::Header, index_offset), ~std::uint64_t(0));
+        BOOST_CHECK_THROW(Mapped::load(filename), std::runtime_error);
+        // block offsets are checked on access: the second block starts after the index
+        const auto second_offset_pos = header.index_offset + sizeof(sparse_file::BlockIndexEntry)
+                                       + offsetof(sparse_file::BlockIndexEntry, offset);
+        save_patched(second_offset_pos, header.index_offset + 1);
+        {
+            auto m = Mapped::load(filename);
+            BOOST_CHECK_THROW(m[99][99], std::runtime_error);
+            BOOST_CHECK_THROW(m[0][1], std::runtime_error);
+            auto count_entries = [&m]() {
+                std::size_t count = 0;
+                for (auto it = m.begin(); it != m.end(); ++it) {
+                    ++count;
+                }
+                return count;
+            };
+            BOOST_CHECK_THROW(count_entries(), std::runtime_error);
+        }
+        // the second block starts before the first one
+        save_patched(second_offset_pos, 0);
+        BOOST_CHECK_THROW(Mapped::load(filename)[99][99], std::runtime_error);
+        std::remove(filename.c_str());
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(Concurrent_matrix_test_suite)
+
+    BOOST_AUTO_TEST_CASE(test_set_n_get) {
+        constexpr int ZERO_VALUE = -1;
+        ConcurrentSparseMatrixDOK<int, ZERO_VALUE> m;
+        BOOST_CHECK(m.size() == 0);
+        BOOST_CHECK(m(0, 0) == ZERO_VALUE);
+        m(100, 100) = 314;
+        BOOST_CHECK(m(100, 100) == 314);
+        BOOST_CHECK(m.size() == 1);
+        m(100, 100) = ZERO_VALUE;
+        BOOST_CHECK(m.size() == 0);
+    }
+
+    BOOST_AUTO_TEST_CASE(test_concurrent_accumulate) {
+        constexpr int THREADS = 8;
+        constexpr int N = 100;
+        ConcurrentSparseMatrixDOK<int, 0> m;
+        vector<thread> threads;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&m]{
+                for (int i = 0; i < N; ++i) {
+                    for (int j = 0; j < 10; ++j) {
+                        m(i, j) += 1;
+                    }
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        BOOST_CHECK(m.size() == N * 10);
+        auto snapshot = m.snapshot();
+        BOOST_CHECK(snapshot.size() == N * 10);
+        for (auto c : snapshot) {
+            BOOST_CHECK(get<2>(c) == THREADS);
+        }
+        m(0, 0) += -THREADS;
+        BOOST_CHECK(m.size() == N * 10 - 1);
+        BOOST_CHECK(m(0, 0) == 0);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,69 @@
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <unistd.h>
+
+#include "bulk.h"
+#include "command_handler.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace {
+
+/// feeds commands_count commands to the manager with the only observer,
+/// returns time including destruction of the observer (the last commit of the log)
+template <typename Handler, typename ... Args>
+double run(std::size_t commands_count, std::size_t bulk_size, Args&& ... args) {
+    auto start = chrono::steady_clock::now();
+    {
+        BulkCmdManager bulkMgr(bulk_size);
+        createObserverAndSubscribe<Handler>(&bulkMgr, std::forward<Args>(args)...);
+        for (std::size_t i = 0; i < commands_count; ++i) {
+            bulkMgr.add_cmd(Command{CommandType::Base, "cmd" + to_string(i)});
+        }
+        bulkMgr.add_cmd(Command{CommandType::Terminator});
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+std::size_t files_count(const fs::path& dir) {
+    return static_cast<std::size_t>(distance(fs::directory_iterator(dir), fs::directory_iterator{}));
+}
+
+} // namespace
+
+// bench_bulk [commands_count]
+int main(int argc, char* argv[]) {
+    std::size_t commands_count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 20'000;
+    auto dir = fs::temp_directory_path() / ("bulk_bench_" + to_string(getpid()));
+    auto old_cwd = fs::current_path();
+
+    for (std::size_t bulk_size : {1, 10, 100}) {
+        // CmdFileHandler writes to the current directory
+        auto files_dir = dir / ("files_" + to_string(bulk_size));
+        fs::create_directories(files_dir);
+        fs::current_path(files_dir);
+        auto files_time = run<CmdFileHandler>(commands_count, bulk_size);
+        fs::current_path(old_cwd);
+
+        SegmentLogOptions options;
+        options.dir = (dir / ("log_" + to_string(bulk_size))).string();
+        auto log_time = run<CmdLogHandler>(commands_count, bulk_size, options);
+
+        cout << "bulk size " << bulk_size << ": "
+             << "file per bulk " << files_time << " s ("
+             << static_cast<double>(commands_count) / files_time << " cmd/s), "
+             << "segment log " << log_time << " s ("
+             << static_cast<double>(commands_count) / log_time << " cmd/s, "
+             << files_count(options.dir) << " segments, "
+             << readBulkIndex(options.dir).size() << " bulks)\n";
+    }
+    fs::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,21 @@
+#include <iostream>
+
+#include "segment_log.h"
+
+using namespace std;
+
+// bulk_log_export <log directory> [output directory]
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        cerr << "Usage: bulk_log_export <log directory> [output directory]" << endl;
+        return -1;
+    }
+    try {
+        auto count = exportBulkFiles(argv[1], argc > 2 ? argv[2] : ".");
+        cout << count << " bulk files are exported" << endl;
+    } catch (const std::exception& e) {
+        cerr << e.what() << endl;
+        return -2;
+    }
+    return 0;
+}
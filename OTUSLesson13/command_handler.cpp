@@ -29,6 +29,10 @@ void CmdFileHandler::update(BulkCmdHolder bulk) {
     }
 }
 
+void CmdLogHandler::update(BulkCmdHolder bulk) {
+    log_.append(*bulk);
+}
+
 std::string CmdFileHandler::getFileName(const BulkCmd& bulk) {
     return "bulk" + to_string(bulk.time_)
 #ifdef TEST
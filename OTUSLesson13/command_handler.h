@@ -12,6 +12,7 @@
 #include <memory>
 
 #include "bulk.h"
+#include "segment_log.h"
 
 /**
  * @brief Subscriber interface.
@@ -57,6 +58,22 @@ private:
 #endif
 };
 
+/**
+ * @brief Command handler implementation. Appends bulks to segmented log.
+ *
+ * Replacement of CmdFileHandler for heavy input: bulks are appended to segment files
+ * with group commit instead of file per bulk, bulk files can be restored by exportBulkFiles.
+ */
+class CmdLogHandler : public IObserver {
+public:
+    explicit CmdLogHandler(SegmentLogOptions options = {})
+        : log_(std::move(options)) {}
+
+    void update(BulkCmdHolder bulk) override;
+private:
+    SegmentLogWriter log_;
+};
+
 template <typename T, typename ... Args>
 ObserverHolder createObserverAndSubscribe(BulkCmdManager* bulkCmdManager, Args&& ... args) {
     auto res = std::make_shared<T>(std::forward<Args>(args)...);
@@ -11,7 +11,7 @@ using namespace std;
 
 int main(int argc, char* argv[]) {
     if (argc < 2) {
-        cerr << "Incorrect parameter number. Bulk must have one parameter: bulk size" << endl;
+        cerr << "Incorrect parameter number. Usage: bulk <bulk size> [log directory]" << endl;
         return -1;
     }
     size_t bulk_size = 0;
@@ -27,7 +27,13 @@ int main(int argc, char* argv[]) {
     auto bulkMgr = make_unique<BulkCmdManager>(bulk_size);
     auto commandReader = make_unique<StreamCmdReader>(cin);
     createObserverAndSubscribe<CmdStreamHandler>(bulkMgr.get());
-    createObserverAndSubscribe<CmdFileHandler>(bulkMgr.get());
+    if (argc > 2) {
+        SegmentLogOptions log_options;
+        log_options.dir = argv[2];
+        createObserverAndSubscribe<CmdLogHandler>(bulkMgr.get(), log_options);
+    } else {
+        createObserverAndSubscribe<CmdFileHandler>(bulkMgr.get());
+    }
 
     // start commands cycle
     process_all_commands(commandReader.get(), bulkMgr.get());
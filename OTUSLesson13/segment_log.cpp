@@ -0,0 +1,321 @@
+#include "segment_log.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_set>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <boost/crc.hpp>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::uint32_t RECORD_MAGIC = 0x4b4c5542; // "BULK"
+constexpr const char* SEGMENT_PREFIX = "bulk_";
+constexpr const char* SEGMENT_EXT = ".seg";
+
+struct RecordHeader {
+    std::uint32_t magic = RECORD_MAGIC;
+    std::uint32_t commands_count = 0;
+    std::int64_t time = 0;
+    std::uint64_t seq = 0;
+    std::uint32_t size = 0;
+    std::uint32_t crc = 0;
+};
+
+std::uint32_t payload_crc(const char* data, std::size_t size) {
+    boost::crc_32_type crc;
+    crc.process_bytes(data, size);
+    return crc.checksum();
+}
+
+/// number of the segment from its file name, false if it isn't a segment
+bool parse_segment_name(const fs::path& path, std::uint64_t& num) {
+    auto name = path.filename().string();
+    auto prefix_len = strlen(SEGMENT_PREFIX);
+    auto ext_len = strlen(SEGMENT_EXT);
+    if (name.size() <= prefix_len + ext_len
+        || name.compare(0, prefix_len, SEGMENT_PREFIX) != 0
+        || name.compare(name.size() - ext_len, ext_len, SEGMENT_EXT) != 0)
+    {
+        return false;
+    }
+    auto digits = name.substr(prefix_len, name.size() - prefix_len - ext_len);
+    if (!all_of(digits.begin(), digits.end(), [](char c) {return c >= '0' && c <= '9';})) {
+        return false;
+    }
+    num = stoull(digits);
+    return true;
+}
+
+/// segment files of the log in the order of writing
+std::vector<fs::path> list_segments(const std::string& dir) {
+    std::vector<std::pair<std::uint64_t, fs::path>> segments;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        std::uint64_t num = 0;
+        if (entry.is_regular_file() && parse_segment_name(entry.path(), num)) {
+            segments.emplace_back(num, entry.path());
+        }
+    }
+    sort(segments.begin(), segments.end());
+    std::vector<fs::path> res;
+    res.reserve(segments.size());
+    for (auto& s : segments) {
+        res.push_back(std::move(s.second));
+    }
+    return res;
+}
+
+std::string segment_name(std::uint64_t num) {
+    // fixed width: lexicographic order of names is the order of segments
+    auto digits = to_string(num);
+    return SEGMENT_PREFIX + string(20 - digits.size(), '0') + digits + SEGMENT_EXT;
+}
+
+/// valid records of the segment are added to index, reading stops on the first truncated or corrupted record
+void read_segment_index(const fs::path& segment, std::vector<BulkIndexEntry>& index) {
+    ifstream in(segment, ios::binary);
+    std::string payload;
+    std::uint64_t offset = 0;
+    RecordHeader header;
+    while (in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        if (header.magic != RECORD_MAGIC) break;
+        payload.resize(header.size);
+        if (!in.read(payload.data(), header.size)
+            || payload_crc(payload.data(), payload.size()) != header.crc)
+        {
+            break;
+        }
+        offset += sizeof(header);
+        index.push_back(BulkIndexEntry{segment.string(), offset, header.size,
+                                       header.commands_count, header.time, header.seq});
+        offset += header.size;
+    }
+}
+
+/// size of the buffer prefix of whole records not longer than size
+std::size_t whole_records_size(const std::string& buffer, std::size_t size) {
+    std::size_t pos = 0;
+    while (pos + sizeof(RecordHeader) <= size) {
+        RecordHeader header;
+        memcpy(&header, buffer.data() + pos, sizeof(header));
+        auto record_size = sizeof(header) + header.size;
+        if (pos + record_size > size) break;
+        pos += record_size;
+    }
+    return pos;
+}
+
+} // namespace
+
+// SegmentLogWriter
+SegmentLogWriter::SegmentLogWriter(SegmentLogOptions options)
+    : options_(std::move(options))
+{
+    fs::create_directories(options_.dir);
+    // log is continued after the last segment and the last bulk of the previous runs
+    auto segments = list_segments(options_.dir);
+    if (!segments.empty()) {
+        parse_segment_name(segments.back(), next_segment_);
+        ++next_segment_;
+    }
+    // seq grows through segments: the last one with valid records has the last bulk,
+    // the empty ones after it are left by failed runs
+    std::vector<BulkIndexEntry> index;
+    for (auto it = segments.rbegin(); it != segments.rend() && index.empty(); ++it) {
+        read_segment_index(*it, index);
+    }
+    if (!index.empty()) {
+        next_seq_ = index.back().seq + 1;
+    }
+    committer_ = thread(&SegmentLogWriter::committer_loop, this);
+}
+
+SegmentLogWriter::~SegmentLogWriter() {
+    {
+        lock_guard lk(mtx_);
+        done_ = true;
+    }
+    cv_.notify_one();
+    committer_.join();
+    try {
+        lock_guard lk(mtx_);
+        commit_locked();
+    } catch (const std::exception&) {
+        // nothing can be done in dtor, the tail of the log is lost
+    }
+    close_segment();
+}
+
+void SegmentLogWriter::append(const BulkCmd& bulk) {
+    RecordHeader header;
+    header.commands_count = static_cast<std::uint32_t>(bulk.data_.size());
+    header.time = static_cast<std::int64_t>(bulk.time_);
+
+    lock_guard lk(mtx_);
+    if (error_) {
+        // background commits fail, the caller must know that bulks aren't saved
+        rethrow_exception(error_);
+    }
+    bool was_empty = buffer_.empty();
+    header.seq = next_seq_++;
+    auto header_pos = buffer_.size();
+    buffer_.append(sizeof(header), '\0');
+    auto payload_pos = buffer_.size();
+    for (const auto& c : bulk.data_) {
+        buffer_ += c.data;
+        buffer_ += '\n';
+    }
+    header.size = static_cast<std::uint32_t>(buffer_.size() - payload_pos);
+    header.crc = payload_crc(buffer_.data() + payload_pos, header.size);
+    memcpy(&buffer_[header_pos], &header, sizeof(header));
+
+    if (buffer_.size() >= options_.commit_size) {
+        commit_locked();
+    } else if (was_empty) {
+        // commit timer starts from the oldest pending bulk
+        cv_.notify_one();
+    }
+}
+
+void SegmentLogWriter::commit() {
+    lock_guard lk(mtx_);
+    commit_locked();
+}
+
+std::size_t SegmentLogWriter::commitsCount() const {
+    lock_guard lk(mtx_);
+    return commits_count_;
+}
+
+std::size_t SegmentLogWriter::segmentsCount() const {
+    lock_guard lk(mtx_);
+    return segments_count_;
+}
+
+void SegmentLogWriter::commit_locked() {
+    if (buffer_.empty()) return;
+    if (fd_ < 0) {
+        open_segment();
+    }
+    std::size_t done = 0;
+    while (done < buffer_.size()) {
+        auto n = ::write(fd_, buffer_.data() + done, buffer_.size() - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) {
+            rollback_commit(done);
+            throw runtime_error("can't write bulk log segment in " + options_.dir + ": " + strerror(errno));
+        }
+        done += static_cast<std::size_t>(n);
+    }
+    int res = 0;
+    while ((res = ::fdatasync(fd_)) != 0 && errno == EINTR) {}
+    if (res != 0) {
+        auto err = errno;
+        rollback_commit(done);
+        throw runtime_error("can't sync bulk log segment in " + options_.dir + ": " + strerror(err));
+    }
+    segment_written_ += buffer_.size();
+    buffer_.clear();
+    ++commits_count_;
+    failures_count_ = 0;
+    error_ = nullptr;
+    if (segment_written_ >= options_.segment_size) {
+        close_segment();
+    }
+}
+
+void SegmentLogWriter::rollback_commit(std::size_t written) {
+    auto err = errno;
+    // the segment is cut to its committed size, so the retry doesn't duplicate records
+    if (::ftruncate(fd_, static_cast<off_t>(segment_written_)) != 0) {
+        // records written as a whole stay in the segment, the torn one becomes its tail
+        // and pending records go to the next segment
+        buffer_.erase(0, whole_records_size(buffer_, written));
+        close_segment();
+    }
+    errno = err;
+}
+
+void SegmentLogWriter::open_segment() {
+    auto path = fs::path(options_.dir) / segment_name(next_segment_++);
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw runtime_error("can't create bulk log segment " + path.string());
+    }
+    segment_written_ = 0;
+    ++segments_count_;
+}
+
+void SegmentLogWriter::close_segment() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+void SegmentLogWriter::committer_loop() {
+    unique_lock lk(mtx_);
+    while (!done_) {
+        if (buffer_.empty()) {
+            cv_.wait(lk, [this] {return done_ || !buffer_.empty();});
+            continue;
+        }
+        if (cv_.wait_for(lk, options_.commit_interval, [this] {return done_ || buffer_.empty();})) {
+            continue;
+        }
+        try {
+            commit_locked();
+        } catch (const std::exception&) {
+            // records stay in the buffer, the next commit retries them;
+            // persistent failure is reported by append and commit
+            if (++failures_count_ >= MAX_COMMIT_FAILURES) {
+                error_ = current_exception();
+            }
+        }
+    }
+}
+
+// reading
+std::vector<BulkIndexEntry> readBulkIndex(const std::string& dir) {
+    std::vector<BulkIndexEntry> index;
+    for (const auto& segment : list_segments(dir)) {
+        read_segment_index(segment, index);
+    }
+    return index;
+}
+
+std::string readBulk(const BulkIndexEntry& entry) {
+    ifstream in(entry.segment, ios::binary);
+    std::string payload(entry.size, '\0');
+    if (!in.seekg(static_cast<std::streamoff>(entry.offset)) || !in.read(payload.data(), entry.size)) {
+        throw runtime_error("can't read bulk from " + entry.segment);
+    }
+    return payload;
+}
+
+std::size_t exportBulkFiles(const std::string& log_dir, const std::string& out_dir) {
+    fs::create_directories(out_dir);
+    std::unordered_set<std::string> names;
+    std::size_t count = 0;
+    for (const auto& entry : readBulkIndex(log_dir)) {
+        // file per bulk named by time of the first command, bulks of the same second get seq suffix
+        auto name = "bulk" + to_string(entry.time) + ".log";
+        if (!names.insert(name).second) {
+            name = "bulk" + to_string(entry.time) + "_" + to_string(entry.seq) + ".log";
+        }
+        ofstream out(fs::path(out_dir) / name, ios::binary);
+        out << readBulk(entry);
+        ++count;
+    }
+    return count;
+}
@@ -0,0 +1,98 @@
+#pragma once
+/**@file
+    @brief Segmented bulk log
+
+    Append-only log of bulks: bulks are appended to rolling segment files instead of
+    a file per bulk, fsyncs are group-committed on size threshold or timer.
+    Log index restores the per-bulk view (bulk[TIME].log files).
+*/
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bulk.h"
+
+/// Segment log parameters
+struct SegmentLogOptions {
+    std::string dir = ".";                          ///< directory of segment files
+    std::size_t segment_size = 64 << 20;            ///< segment is closed when it's bigger
+    std::size_t commit_size = 1 << 20;              ///< pending bytes which are committed at once
+    std::chrono::milliseconds commit_interval{200}; ///< max time before pending bulks are committed
+};
+
+/**
+ * @brief Segment log writer
+ *
+ * Bulk record: header (magic, commands count, time of the first command, sequence number,
+ * payload size, payload crc32) and payload -- commands separated with '\n', as in bulk file.
+ * Segment files are named bulk_[N].seg, where [N] -- number of the segment in the log.
+ * Records are buffered and written with one write and fdatasync (group commit),
+ * when commit_size bytes are pending or commit_interval is over (background thread).
+ * Writer always starts a new segment, so a torn tail after crash stays the last record of its segment.
+ * Failed commit is cut off the segment and retried; after MAX_COMMIT_FAILURES failed background
+ * commits in a row append throws the error until a commit succeeds.
+ */
+class SegmentLogWriter {
+public:
+    explicit SegmentLogWriter(SegmentLogOptions options = {});
+    ~SegmentLogWriter();
+    SegmentLogWriter(const SegmentLogWriter&) = delete;
+    SegmentLogWriter& operator=(const SegmentLogWriter&) = delete;
+
+    void append(const BulkCmd& bulk);
+    /// writes and syncs pending records
+    void commit();
+
+    [[nodiscard]] std::size_t commitsCount() const;
+    [[nodiscard]] std::size_t segmentsCount() const;
+private:
+    static constexpr std::size_t MAX_COMMIT_FAILURES = 3;
+
+    SegmentLogOptions options_;
+    std::string buffer_;
+    std::uint64_t next_seq_ = 0;
+    std::uint64_t next_segment_ = 0;
+    int fd_ = -1;
+    std::size_t segment_written_ = 0;
+    std::size_t commits_count_ = 0;
+    std::size_t segments_count_ = 0;
+    std::size_t failures_count_ = 0;        ///< failed background commits in a row
+    std::exception_ptr error_;              ///< the last error of persistent failure
+    bool done_ = false;
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    std::thread committer_;
+    // methods
+    void commit_locked();
+    /// removes the failed commit from the segment, written -- bytes of buffer_ written to it
+    void rollback_commit(std::size_t written);
+    void open_segment();
+    void close_segment();
+    void committer_loop();
+};
+
+/// Bulk record position in the log
+struct BulkIndexEntry {
+    std::string segment;
+    std::uint64_t offset = 0;       ///< payload offset in the segment
+    std::uint32_t size = 0;         ///< payload size
+    std::uint32_t commands_count = 0;
+    std::int64_t time = 0;
+    std::uint64_t seq = 0;
+};
+
+/// index of all valid bulk records of the log ordered by sequence number,
+/// reading of a segment stops on its first truncated or corrupted record
+std::vector<BulkIndexEntry> readBulkIndex(const std::string& dir);
+
+/// payload of the bulk record (content of bulk file)
+std::string readBulk(const BulkIndexEntry& entry);
+
+/// writes bulk[TIME].log file for every bulk of the log, returns number of files
+std::size_t exportBulkFiles(const std::string& log_dir, const std::string& out_dir);
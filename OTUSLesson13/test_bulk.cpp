@@ -2,10 +2,18 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/signals2.hpp>
 
+#include <filesystem>
+#include <fstream>
 #include <memory>
+#include <set>
 #include <sstream>
 #include <vector>
 
+#include <csignal>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
 #include "bulk.h"
 #include "command_reader.h"
 #include "command_handler.h"
@@ -147,4 +155,157 @@ BOOST_AUTO_TEST_SUITE(cmd_reader_test_suite)
         }
     }
 
-BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(segment_log_test_suite)
+
+    namespace fs = std::filesystem;
+
+    /// temporary directory removed at the end of the test
+    struct TempDir {
+        fs::path path = fs::temp_directory_path() / ("test_bulk_log_" + to_string(getpid()));
+        TempDir() {fs::remove_all(path);}
+        ~TempDir() {fs::remove_all(path);}
+    };
+
+    std::string read_file(const fs::path& path) {
+        ifstream in(path, ios::binary);
+        return string(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    }
+
+    BOOST_AUTO_TEST_CASE(test_log_handler) {
+        TempDir tmp;
+        SegmentLogOptions options;
+        options.dir = tmp.path.string();
+        options.segment_size = 16;
+        options.commit_size = 1;
+        {
+            stringstream in;
+            in << "cmd1\n" << "cmd2\n" << "cmd3\n" << "{\n" << "cmd4\n" << "cmd5\n" << "}\n" << "cmd6\n";
+            auto bulkMgr = make_unique<BulkCmdManager>(3);
+            auto commandReader = make_unique<StreamCmdReader>(in);
+            createObserverAndSubscribe<CmdLogHandler>(bulkMgr.get(), options);
+            process_all_commands(commandReader.get(), bulkMgr.get());
+        }
+        auto index = readBulkIndex(options.dir);
+        BOOST_REQUIRE(index.size() == 3u);
+        BOOST_CHECK(readBulk(index[0]) == "cmd1\ncmd2\ncmd3\n");
+        BOOST_CHECK(readBulk(index[1]) == "cmd4\ncmd5\n");
+        BOOST_CHECK(readBulk(index[2]) == "cmd6\n");
+        BOOST_CHECK(index[0].commands_count == 3u);
+        BOOST_CHECK(index[2].seq == 2u);
+        // every commit is bigger than segment size
+        BOOST_CHECK(index[0].segment != index[1].segment);
+
+        // per-bulk view
+        auto out_dir = tmp.path / "export";
+        BOOST_CHECK(exportBulkFiles(options.dir, out_dir.string()) == 3u);
+        multiset<string> files;
+        for (const auto& entry : fs::directory_iterator(out_dir)) {
+            files.insert(read_file(entry.path()));
+        }
+        BOOST_CHECK(files == multiset<string>({"cmd1\ncmd2\ncmd3\n", "cmd4\ncmd5\n", "cmd6\n"}));
+    }
+
+    BOOST_AUTO_TEST_CASE(test_log_group_commit) {
+        TempDir tmp;
+        SegmentLogOptions options;
+        options.dir = tmp.path.string();
+        options.commit_interval = std::chrono::hours(1);
+        SegmentLogWriter log(options);
+        for (int i = 0; i < 100; ++i) {
+            log.append(BulkCmd(i, {Command{CommandType::Base, "cmd" + to_string(i)}}));
+        }
+        BOOST_CHECK(log.commitsCount() == 0u);
+        BOOST_CHECK(readBulkIndex(options.dir).empty());
+        log.commit();
+        BOOST_CHECK(log.commitsCount() == 1u);
+        BOOST_CHECK(log.segmentsCount() == 1u);
+        BOOST_CHECK(readBulkIndex(options.dir).size() == 100u);
+    }
+
+    BOOST_AUTO_TEST_CASE(test_log_commit_timer) {
+        TempDir tmp;
+        SegmentLogOptions options;
+        options.dir = tmp.path.string();
+        options.commit_interval = std::chrono::milliseconds(10);
+        SegmentLogWriter log(options);
+        log.append(BulkCmd(1, {Command{CommandType::Base, "cmd"}}));
+        for (int i = 0; i < 500 && log.commitsCount() == 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        BOOST_CHECK(log.commitsCount() == 1u);
+        BOOST_CHECK(readBulkIndex(options.dir).size() == 1u);
+    }
+
+    BOOST_AUTO_TEST_CASE(test_log_torn_tail) {
+        TempDir tmp;
+        SegmentLogOptions options;
+        options.dir = tmp.path.string();
+        {
+            SegmentLogWriter log(options);
+            log.append(BulkCmd(1, {Command{CommandType::Base, "cmd1"}}));
+            log.append(BulkCmd(2, {Command{CommandType::Base, "cmd2"}}));
+        }
+        auto index = readBulkIndex(options.dir);
+        BOOST_REQUIRE(index.size() == 2u);
+        // crash in the middle of the last record
+        fs::resize_file(index[1].segment, index[1].offset + 2);
+        BOOST_CHECK(readBulkIndex(options.dir).size() == 1u);
+
+        // the next run starts a new segment after the valid records
+        {
+            SegmentLogWriter log(options);
+            log.append(BulkCmd(3, {Command{CommandType::Base, "cmd3"}}));
+        }
+        index = readBulkIndex(options.dir);
+        BOOST_REQUIRE(index.size() == 2u);
+        BOOST_CHECK(index[1].seq == 1u);
+        BOOST_CHECK(readBulk(index[1]) == "cmd3\n");
+        BOOST_CHECK(index[0].segment != index[1].segment);
+
+        // segment of a failed run without records is skipped
+        ofstream(fs::path(options.dir) / "bulk_00000000000000000009.seg").close();
+        {
+            SegmentLogWriter log(options);
+            log.append(BulkCmd(4, {Command{CommandType::Base, "cmd4"}}));
+        }
+        index = readBulkIndex(options.dir);
+        BOOST_REQUIRE(index.size() == 3u);
+        BOOST_CHECK(index[2].seq == 2u);
+    }
+
+    BOOST_AUTO_TEST_CASE(test_log_write_failure) {
+        TempDir tmp;
+        SegmentLogOptions options;
+        options.dir = tmp.path.string();
+        options.commit_interval = std::chrono::hours(1);
+        const string payload(1000, 'x');
+        SegmentLogWriter log(options);
+        log.append(BulkCmd(1, {Command{CommandType::Base, payload}}));
+        log.commit();
+
+        // file size limit: the next commit is written partially, then write fails
+        rlimit old_limit{};
+        getrlimit(RLIMIT_FSIZE, &old_limit);
+        auto old_handler = signal(SIGXFSZ, SIG_IGN);
+        rlimit limit = old_limit;
+        limit.rlim_cur = 2500;
+        setrlimit(RLIMIT_FSIZE, &limit);
+        log.append(BulkCmd(2, {Command{CommandType::Base, payload}}));
+        log.append(BulkCmd(3, {Command{CommandType::Base, payload}}));
+        BOOST_CHECK_THROW(log.commit(), std::runtime_error);
+        setrlimit(RLIMIT_FSIZE, &old_limit);
+        signal(SIGXFSZ, old_handler);
+
+        // the retry continues the segment without duplicates
+        log.commit();
+        BOOST_CHECK(log.segmentsCount() == 1u);
+        auto index = readBulkIndex(options.dir);
+        BOOST_REQUIRE(index.size() == 3u);
+        for (std::uint64_t i = 0; i < index.size(); ++i) {
+            BOOST_CHECK(index[i].seq == i);
+        }
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "block_layout.h"
+#include "crc32c.h"
+#include "file_cmp.h"
+#include "hasher.h"
+
+using namespace std;
+namespace fs = boost::filesystem;
+
+namespace {
+
+/// mixed tree: small files of up to 16 KiB and big files of 1-4 MiB, every 10th file is
+/// a copy of the previous one, half of the others differ from the neighbours
+/// in the first bytes and half only in the last ones
+vector<string> make_tree(const fs::path& dir, size_t files_count) {
+    mt19937 gen(42);
+    constexpr size_t SMALL_SIZE = 1024;
+    constexpr size_t BIG_SIZE = size_t{1} << 20;
+    vector<string> files;
+    files.reserve(files_count);
+    string content;
+    for (size_t i = 0; i < files_count; ++i) {
+        auto subdir = dir / to_string(i / 1000);
+        if (i % 1000 == 0) {
+            fs::create_directories(subdir);
+        }
+        if (i % 10 != 0) {
+            size_t size = i % 20 < 18 ? (i % 16 + 1) * SMALL_SIZE : (i % 4 + 1) * BIG_SIZE;
+            content.assign(size, 'a');
+            (i % 2 ? content.front() : content.back()) = static_cast<char>(gen());
+        }
+        auto fname = (subdir / to_string(i)).string();
+        ofstream(fname, ios::binary) << content;
+        files.push_back(fname);
+    }
+    return files;
+}
+
+/// counts bytes passed to the wrapped hasher
+class ByteCountingHasher : public IHasher {
+public:
+    explicit ByteCountingHasher(IHasher& hasher) : hasher_(hasher) {}
+
+    Hash operator()(ByteSpan bytes) override {
+        bytes_ += bytes.size();
+        return hasher_(bytes);
+    }
+
+    [[nodiscard]] uint64_t bytes() const {return bytes_;}
+
+private:
+    IHasher& hasher_;
+    std::atomic<uint64_t> bytes_{0};
+};
+
+string layout_name(const BlockLayout& layout) {
+    if (layout.isFixed()) {
+        return "fixed " + to_string(layout.maxBlockSize());
+    }
+    return "adaptive " + to_string(layout.minBlockSize()) + ":" + to_string(layout.maxBlockSize());
+}
+
+/// throughput of every hasher on blocks of block_size bytes which are in cache
+void bench_hashers(size_t block_size) {
+    constexpr size_t TOTAL_BYTES = size_t{1} << 28;
+    vector<char> block(block_size);
+    mt19937 gen(42);
+    for (auto& c : block) {
+        c = static_cast<char>(gen());
+    }
+    size_t rounds = max<size_t>(TOTAL_BYTES / block_size, 1);
+    for (auto hash_type : {HashType::Boost, HashType::CRC32, HashType::CRC32C,
+                           HashType::XXH128, HashType::BLAKE3})
+    {
+        auto hasher = makeHasher(hash_type);
+        uint64_t sink = 0;
+        auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < rounds; ++i) {
+            block[0] = static_cast<char>(i);
+            sink ^= (*hasher)(block).low;
+        }
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        cout << hashTypeName(hash_type) << ": "
+             << static_cast<double>(rounds * block_size) / elapsed.count() / 1e9 << " GB/s"
+             << (hash_type == HashType::CRC32C && !crc32c_hw_available() ? " (software)" : "")
+             << " [" << (sink & 1) << "]\n";
+    }
+}
+
+} // namespace
+
+// bench_bayan [files_count] [threads]
+int main(int argc, char* argv[]) {
+    size_t files_count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 2'000;
+    size_t threads_num = argc > 2 ? strtoull(argv[2], nullptr, 10) : 1;
+    bench_hashers(4096);
+
+    auto dir = fs::temp_directory_path() / fs::unique_path("bayan_bench_%%%%-%%%%");
+    auto files = make_tree(dir, files_count);
+
+    auto xxh128 = makeHasher(HashType::XXH128);
+    for (const auto& layout : {BlockLayout::fixed(4096), BlockLayout::fixed(1 << 20),
+                               BlockLayout::adaptive(4096, 1 << 20)})
+    {
+        for (auto read_mode : {ReadMode::Pread, ReadMode::Mmap}) {
+            ByteCountingHasher hasher(*xxh128);
+            CompareFiles fileComparator(layout, hasher, threads_num, read_mode);
+            auto start = chrono::steady_clock::now();
+            auto res = fileComparator.compare(files);
+            chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+            cout << layout_name(layout) << ", "
+                 << (read_mode == ReadMode::Mmap ? "mmap" : "pread") << ": "
+                 << res.size() << " groups, " << elapsed.count() << " s, "
+                 << static_cast<double>(hasher.bytes()) / (1 << 20) << " MiB hashed\n";
+        }
+    }
+    fs::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,206 @@
+#include "blake3.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t BLOCK_LEN = 64;
+constexpr std::size_t CHUNK_LEN = 1024;
+
+constexpr std::uint32_t CHUNK_START = 1u << 0;
+constexpr std::uint32_t CHUNK_END = 1u << 1;
+constexpr std::uint32_t PARENT = 1u << 2;
+constexpr std::uint32_t ROOT = 1u << 3;
+
+constexpr std::uint32_t IV[8] = {
+    0x6A09E667u, 0xBB67AE85u, 0x3C6EF372u, 0xA54FF53Au,
+    0x510E527Fu, 0x9B05688Cu, 0x1F83D9ABu, 0x5BE0CD19u,
+};
+
+constexpr std::size_t MSG_PERMUTATION[16] = {2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8};
+
+using ChainingValue = std::array<std::uint32_t, 8>;
+using BlockWords = std::array<std::uint32_t, 16>;
+
+std::uint32_t rotr(std::uint32_t x, unsigned r) {
+    return (x >> r) | (x << (32 - r));
+}
+
+void g(std::uint32_t* state, std::size_t a, std::size_t b, std::size_t c, std::size_t d,
+        std::uint32_t mx, std::uint32_t my)
+{
+    state[a] = state[a] + state[b] + mx;
+    state[d] = rotr(state[d] ^ state[a], 16);
+    state[c] = state[c] + state[d];
+    state[b] = rotr(state[b] ^ state[c], 12);
+    state[a] = state[a] + state[b] + my;
+    state[d] = rotr(state[d] ^ state[a], 8);
+    state[c] = state[c] + state[d];
+    state[b] = rotr(state[b] ^ state[c], 7);
+}
+
+void round_fn(std::uint32_t* state, const BlockWords& m) {
+    g(state, 0, 4, 8, 12, m[0], m[1]);
+    g(state, 1, 5, 9, 13, m[2], m[3]);
+    g(state, 2, 6, 10, 14, m[4], m[5]);
+    g(state, 3, 7, 11, 15, m[6], m[7]);
+    g(state, 0, 5, 10, 15, m[8], m[9]);
+    g(state, 1, 6, 11, 12, m[10], m[11]);
+    g(state, 2, 7, 8, 13, m[12], m[13]);
+    g(state, 3, 4, 9, 14, m[14], m[15]);
+}
+
+std::array<std::uint32_t, 16> compress(const ChainingValue& cv, BlockWords block,
+        std::uint64_t counter, std::uint32_t block_len, std::uint32_t flags)
+{
+    std::array<std::uint32_t, 16> state = {
+        cv[0], cv[1], cv[2], cv[3], cv[4], cv[5], cv[6], cv[7],
+        IV[0], IV[1], IV[2], IV[3],
+        static_cast<std::uint32_t>(counter), static_cast<std::uint32_t>(counter >> 32),
+        block_len, flags,
+    };
+    for (int r = 0; r < 7; ++r) {
+        round_fn(state.data(), block);
+        if (r != 6) {
+            BlockWords permuted;
+            for (std::size_t i = 0; i < 16; ++i) {
+                permuted[i] = block[MSG_PERMUTATION[i]];
+            }
+            block = permuted;
+        }
+    }
+    for (std::size_t i = 0; i < 8; ++i) {
+        state[i] ^= state[i + 8];
+        state[i + 8] ^= cv[i];
+    }
+    return state;
+}
+
+BlockWords words_from_bytes(const std::uint8_t* bytes) {
+    BlockWords words;
+    for (std::size_t i = 0; i < 16; ++i) {
+        words[i] = static_cast<std::uint32_t>(bytes[4 * i])
+                | static_cast<std::uint32_t>(bytes[4 * i + 1]) << 8
+                | static_cast<std::uint32_t>(bytes[4 * i + 2]) << 16
+                | static_cast<std::uint32_t>(bytes[4 * i + 3]) << 24;
+    }
+    return words;
+}
+
+ChainingValue first_8_words(const std::array<std::uint32_t, 16>& words) {
+    ChainingValue cv;
+    std::copy_n(words.begin(), 8, cv.begin());
+    return cv;
+}
+
+/// the last compression of a node, it's done with ROOT flag for the root node
+struct Output {
+    ChainingValue input_cv;
+    BlockWords block_words;
+    std::uint64_t counter;
+    std::uint32_t block_len;
+    std::uint32_t flags;
+
+    ChainingValue chaining_value() const {
+        return first_8_words(compress(input_cv, block_words, counter, block_len, flags));
+    }
+
+    std::array<std::uint8_t, BLAKE3_OUT_LEN> root_hash() const {
+        auto words = compress(input_cv, block_words, 0, block_len, flags | ROOT);
+        std::array<std::uint8_t, BLAKE3_OUT_LEN> res;
+        for (std::size_t i = 0; i < BLAKE3_OUT_LEN / 4; ++i) {
+            for (std::size_t k = 0; k < 4; ++k) {
+                res[4 * i + k] = static_cast<std::uint8_t>(words[i] >> (8 * k));
+            }
+        }
+        return res;
+    }
+};
+
+Output parent_output(const ChainingValue& left, const ChainingValue& right) {
+    BlockWords block;
+    std::copy(left.begin(), left.end(), block.begin());
+    std::copy(right.begin(), right.end(), block.begin() + 8);
+    ChainingValue key;
+    std::copy(std::begin(IV), std::end(IV), key.begin());
+    return {key, block, 0, static_cast<std::uint32_t>(BLOCK_LEN), PARENT};
+}
+
+class ChunkState {
+public:
+    explicit ChunkState(std::uint64_t chunk_counter) : chunk_counter_(chunk_counter) {
+        std::copy(std::begin(IV), std::end(IV), cv_.begin());
+    }
+
+    std::size_t size() const {
+        return BLOCK_LEN * blocks_compressed_ + block_len_;
+    }
+
+    /// data must not exceed the chunk
+    void update(const std::uint8_t* data, std::size_t size) {
+        while (size != 0) {
+            if (block_len_ == BLOCK_LEN) {
+                cv_ = first_8_words(compress(cv_, words_from_bytes(block_), chunk_counter_,
+                        static_cast<std::uint32_t>(BLOCK_LEN), start_flag()));
+                ++blocks_compressed_;
+                std::memset(block_, 0, BLOCK_LEN);
+                block_len_ = 0;
+            }
+            auto take = std::min(BLOCK_LEN - block_len_, size);
+            std::memcpy(block_ + block_len_, data, take);
+            block_len_ += take;
+            data += take;
+            size -= take;
+        }
+    }
+
+    Output output() const {
+        return {cv_, words_from_bytes(block_), chunk_counter_,
+                static_cast<std::uint32_t>(block_len_), start_flag() | CHUNK_END};
+    }
+
+private:
+    ChainingValue cv_;
+    std::uint64_t chunk_counter_ = 0;
+    std::uint8_t block_[BLOCK_LEN] = {};
+    std::size_t block_len_ = 0;
+    std::size_t blocks_compressed_ = 0;
+
+    std::uint32_t start_flag() const {
+        return blocks_compressed_ == 0 ? CHUNK_START : 0;
+    }
+};
+
+} // namespace
+
+std::array<std::uint8_t, BLAKE3_OUT_LEN> blake3(const char* data, std::size_t size) {
+    const auto* input = reinterpret_cast<const std::uint8_t*>(data);
+    std::vector<ChainingValue> cv_stack;
+    std::uint64_t total_chunks = 0;
+    ChunkState chunk(0);
+    while (size != 0) {
+        if (chunk.size() == CHUNK_LEN) {
+            auto chunk_cv = chunk.output().chaining_value();
+            ++total_chunks;
+            // merge completed subtrees: number of trailing zero bits == number of merges
+            for (auto chunks = total_chunks; (chunks & 1) == 0; chunks >>= 1) {
+                chunk_cv = parent_output(cv_stack.back(), chunk_cv).chaining_value();
+                cv_stack.pop_back();
+            }
+            cv_stack.push_back(chunk_cv);
+            chunk = ChunkState(total_chunks);
+        }
+        auto take = std::min(CHUNK_LEN - chunk.size(), size);
+        chunk.update(input, take);
+        input += take;
+        size -= take;
+    }
+    auto output = chunk.output();
+    while (!cv_stack.empty()) {
+        output = parent_output(cv_stack.back(), output.chaining_value());
+        cv_stack.pop_back();
+    }
+    return output.root_hash();
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/// BLAKE3 default output length
+constexpr std::size_t BLAKE3_OUT_LEN = 32;
+
+/**
+ * BLAKE3 hash in the default (unkeyed) mode,
+ * portable single-threaded implementation of the reference algorithm
+ */
+std::array<std::uint8_t, BLAKE3_OUT_LEN> blake3(const char* data, std::size_t size);
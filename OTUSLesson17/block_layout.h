@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+/**
+ * How files are split into blocks for comparison.
+ *
+ * fixed -- all blocks are of block_size.
+ * adaptive -- block sizes grow geometrically: min, 2*min, 4*min, ... up to max,
+ * then all blocks are of max size. Mismatching files are rejected after small reads,
+ * matching files are read with big blocks (few syscalls and hasher calls).
+ *
+ * Block boundaries depend only on the offset, so files of the same size are split
+ * the same way. The last block of fixed layout is padded with zeros up to its size
+ * (as before, hashes in the cache stay valid), the last block of adaptive layout
+ * is truncated at the end of the file: it can be up to max size, padding would be hashed too.
+ */
+class BlockLayout {
+public:
+    static BlockLayout fixed(std::size_t block_size) {
+        if (block_size == 0) {
+            throw std::invalid_argument("Block size can't be zero");
+        }
+        return BlockLayout(block_size, block_size);
+    }
+
+    static BlockLayout adaptive(std::size_t min_block, std::size_t max_block) {
+        if (min_block == 0 || max_block < min_block || max_block > MAX_ADAPTIVE_BLOCK) {
+            throw std::invalid_argument("Bad adaptive block sizes");
+        }
+        return BlockLayout(min_block, max_block);
+    }
+
+    [[nodiscard]] bool isFixed() const {return min_block_ == max_block_;}
+    [[nodiscard]] std::size_t minBlockSize() const {return min_block_;}
+    [[nodiscard]] std::size_t maxBlockSize() const {return max_block_;}
+
+    /// size of block num
+    [[nodiscard]] std::size_t blockSize(std::size_t num) const {
+        if (isFixed() || num >= growth_blocks_) {
+            return max_block_;
+        }
+        return std::min(min_block_ << num, max_block_);
+    }
+
+    /// how many bytes of block num are read and hashed for the file of file_size
+    [[nodiscard]] std::size_t readSize(std::size_t num, std::uint64_t file_size) const {
+        auto size = blockSize(num);
+        if (isFixed()) {
+            return size;
+        }
+        auto offset = blockOffset(num);
+        if (offset >= file_size) {
+            return 0;
+        }
+        return static_cast<std::size_t>(std::min<std::uint64_t>(size, file_size - offset));
+    }
+
+    /// offset of block num in the file
+    [[nodiscard]] std::uint64_t blockOffset(std::size_t num) const {
+        if (isFixed()) {
+            return static_cast<std::uint64_t>(num) * max_block_;
+        }
+        if (num <= growth_blocks_) {
+            // min + 2*min + ... + 2^(num-1)*min
+            return static_cast<std::uint64_t>(min_block_) * ((std::uint64_t{1} << num) - 1);
+        }
+        return growth_size_ + static_cast<std::uint64_t>(num - growth_blocks_) * max_block_;
+    }
+
+    /// number of blocks of the file
+    [[nodiscard]] std::size_t blocksCount(std::uint64_t file_size) const {
+        if (isFixed()) {
+            return static_cast<std::size_t>((file_size + max_block_ - 1) / max_block_);
+        }
+        if (file_size <= growth_size_) {
+            std::size_t num = 0;
+            while (blockOffset(num) < file_size) {
+                ++num;
+            }
+            return num;
+        }
+        return growth_blocks_
+            + static_cast<std::size_t>((file_size - growth_size_ + max_block_ - 1) / max_block_);
+    }
+
+    /// identifier for the hash cache: block size for fixed layout, tagged sizes for adaptive
+    [[nodiscard]] std::uint64_t id() const {
+        if (isFixed()) {
+            return max_block_;
+        }
+        return ADAPTIVE_TAG | (static_cast<std::uint64_t>(min_block_) << 32) | max_block_;
+    }
+
+private:
+    static constexpr std::size_t MAX_ADAPTIVE_BLOCK = std::size_t{1} << 31;
+    static constexpr std::uint64_t ADAPTIVE_TAG = std::uint64_t{1} << 63;
+
+    std::size_t min_block_ = 1;
+    std::size_t max_block_ = 1;
+    /// number of blocks smaller than max and their total size
+    std::size_t growth_blocks_ = 0;
+    std::uint64_t growth_size_ = 0;
+
+    BlockLayout(std::size_t min_block, std::size_t max_block)
+        : min_block_(min_block), max_block_(max_block)
+    {
+        while (!isFixed() && (min_block_ << growth_blocks_) < max_block_) {
+            growth_size_ += min_block_ << growth_blocks_;
+            ++growth_blocks_;
+        }
+    }
+};
@@ -0,0 +1,211 @@
+#include "block_source.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+constexpr std::size_t BUFFER_ALIGNMENT = 4096;
+
+struct FreeDeleter {
+    void operator()(char* p) const { std::free(p); }
+};
+using AlignedBuffer = std::unique_ptr<char, FreeDeleter>;
+
+AlignedBuffer make_aligned_buffer(std::size_t size) {
+    auto aligned_size = (size + BUFFER_ALIGNMENT - 1) / BUFFER_ALIGNMENT * BUFFER_ALIGNMENT;
+    auto p = static_cast<char*>(std::aligned_alloc(BUFFER_ALIGNMENT, aligned_size));
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return AlignedBuffer(p);
+}
+
+/// per-thread buffer: block is hashed right after reading on the same thread,
+/// so one buffer per thread is enough (instead of one per opened file)
+char* thread_buffer(std::size_t size) {
+    thread_local AlignedBuffer buffer;
+    thread_local std::size_t capacity = 0;
+    if (capacity < size) {
+        buffer = make_aligned_buffer(size);
+        capacity = size;
+    }
+    return buffer.get();
+}
+
+class BlockSourceBase : public IBlockSource {
+public:
+    BlockSourceBase(std::string filename, std::size_t file_size, std::size_t max_block_size)
+        : filename_(std::move(filename)), file_size_(file_size), max_block_size_(max_block_size)
+    {}
+    ~BlockSourceBase() override {
+        close_fd();
+    }
+
+protected:
+    std::string filename_;
+    std::size_t file_size_ = 0;
+    std::size_t max_block_size_ = 0;
+    int fd_ = -1;
+    bool failed_ = false;
+
+    bool open_fd() {
+        if (fd_ < 0 && !failed_) {
+            fd_ = ::open(filename_.c_str(), O_RDONLY | O_CLOEXEC);
+            failed_ = fd_ < 0;
+        }
+        return fd_ >= 0;
+    }
+
+    void close_fd() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    /// size of data in the block without padding
+    std::size_t data_size(std::uint64_t offset, std::size_t size) const {
+        return static_cast<std::size_t>(std::min<std::uint64_t>(size, file_size_ - offset));
+    }
+
+    void check_size(std::size_t size) const {
+        if (size > max_block_size_) {
+            throw std::logic_error("block is bigger than max block size of the source");
+        }
+    }
+};
+
+/// reads blocks with pread into the reused aligned buffer
+class PreadBlockSource : public BlockSourceBase {
+public:
+    using BlockSourceBase::BlockSourceBase;
+
+    boost::optional<ByteSpan> read(std::uint64_t offset, std::size_t block_size) override {
+        check_size(block_size);
+        if (offset >= file_size_ || !open_fd()) {
+            return boost::none;
+        }
+        auto* buffer = thread_buffer(block_size);
+        auto size = data_size(offset, block_size);
+        std::size_t done = 0;
+        while (done < size) {
+            auto n = ::pread(fd_, buffer + done, size - done,
+                    static_cast<off_t>(offset + done));
+            if (n <= 0) {
+                failed_ = true;
+                close();
+                return boost::none;
+            }
+            done += static_cast<std::size_t>(n);
+        }
+        // padding of the last block
+        std::memset(buffer + size, 0, block_size - size);
+        return ByteSpan(buffer, block_size);
+    }
+
+    void close() override {
+        close_fd();
+    }
+};
+
+/**
+ * Maps the whole file, only the last (padded) block is copied.
+ * Access to the mapping past the end of a file truncated by another process raises SIGBUS,
+ * so file size is checked before every block and a truncated file is read with pread.
+ */
+class MmapBlockSource : public PreadBlockSource {
+public:
+    using PreadBlockSource::PreadBlockSource;
+    ~MmapBlockSource() override {
+        unmap();
+    }
+
+    boost::optional<ByteSpan> read(std::uint64_t offset, std::size_t block_size) override {
+        check_size(block_size);
+        if (truncated_) {
+            return PreadBlockSource::read(offset, block_size);
+        }
+        if (offset >= file_size_ || !map()) {
+            return boost::none;
+        }
+        auto size = data_size(offset, block_size);
+        if (!file_covers(offset + size)) {
+            truncated_ = true;
+            unmap();
+            // pread reports the short file as read error
+            return PreadBlockSource::read(offset, block_size);
+        }
+        if (size == block_size) {
+            return ByteSpan(data_ + offset, size);
+        }
+        auto* buffer = thread_buffer(block_size);
+        std::memcpy(buffer, data_ + offset, size);
+        std::memset(buffer + size, 0, block_size - size);
+        return ByteSpan(buffer, block_size);
+    }
+
+    void close() override {
+        unmap();
+        close_fd();
+    }
+
+private:
+    const char* data_ = nullptr;
+    bool truncated_ = false;
+
+    bool map() {
+        if (data_) {
+            return true;
+        }
+        if (!open_fd()) {
+            return false;
+        }
+        // descriptor is kept open for size checks
+        void* addr = ::mmap(nullptr, file_size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (addr == MAP_FAILED) {
+            failed_ = true;
+            close_fd();
+            return false;
+        }
+        ::madvise(addr, file_size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(addr);
+        return true;
+    }
+
+    bool file_covers(std::uint64_t end) const {
+        struct stat st{};
+        return ::fstat(fd_, &st) == 0 && static_cast<std::uint64_t>(st.st_size) >= end;
+    }
+
+    void unmap() {
+        if (data_) {
+            ::munmap(const_cast<char*>(data_), file_size_);
+            data_ = nullptr;
+        }
+    }
+};
+
+} // namespace
+
+BlockSourceHolder makeBlockSource(ReadMode read_mode, std::string filename,
+        std::size_t file_size, std::size_t max_block_size)
+{
+    switch (read_mode) {
+        case ReadMode::Pread:
+            return make_unique<PreadBlockSource>(std::move(filename), file_size, max_block_size);
+        case ReadMode::Mmap:
+            return make_unique<MmapBlockSource>(std::move(filename), file_size, max_block_size);
+        default:
+            throw runtime_error("Unknown read mode");
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <boost/optional.hpp>
+
+#include "hasher.h"
+
+/// how file blocks are read
+enum class ReadMode {Pread, Mmap};
+
+/**
+ * Source of file blocks.
+ * Returned span is valid until the next read or close call of any source on the same thread.
+ * The last block is padded with zeroes up to the requested size.
+ */
+class IBlockSource {
+public:
+    virtual ~IBlockSource() = default;
+    /// reads [offset, offset + size), size can't be bigger than max_block_size of the source
+    /// @return boost::none if offset is out of file or file can't be read
+    virtual boost::optional<ByteSpan> read(std::uint64_t offset, std::size_t size) = 0;
+    /// releases file descriptor and mapping, source can be read again after close
+    virtual void close() = 0;
+};
+using BlockSourceHolder = std::unique_ptr<IBlockSource>;
+
+BlockSourceHolder makeBlockSource(ReadMode read_mode, std::string filename,
+        std::size_t file_size, std::size_t max_block_size);
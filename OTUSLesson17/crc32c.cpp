@@ -0,0 +1,94 @@
+#include "crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CRC32C_HW_X86
+#include <nmmintrin.h>
+#endif
+
+namespace {
+
+constexpr std::uint32_t POLY = 0x82F63B78u; // reflected 0x1EDC6F41
+
+/// slicing-by-8 tables
+std::array<std::array<std::uint32_t, 256>, 8> make_tables() {
+    std::array<std::array<std::uint32_t, 256>, 8> tables{};
+    for (std::uint32_t i = 0; i < 256; ++i) {
+        std::uint32_t crc = i;
+        for (int k = 0; k < 8; ++k) {
+            crc = (crc >> 1) ^ (POLY & (0u - (crc & 1u)));
+        }
+        tables[0][i] = crc;
+    }
+    for (std::size_t i = 0; i < 256; ++i) {
+        for (std::size_t t = 1; t < 8; ++t) {
+            auto prev = tables[t - 1][i];
+            tables[t][i] = (prev >> 8) ^ tables[0][prev & 0xffu];
+        }
+    }
+    return tables;
+}
+
+const auto TABLES = make_tables();
+
+#ifdef CRC32C_HW_X86
+__attribute__((target("sse4.2")))
+std::uint32_t crc32c_hw(const char* data, std::size_t size) {
+    std::uint64_t crc = 0xFFFFFFFFu;
+    for (; size >= 8; size -= 8, data += 8) {
+        std::uint64_t v;
+        std::memcpy(&v, data, sizeof(v));
+        crc = _mm_crc32_u64(crc, v);
+    }
+    auto crc32 = static_cast<std::uint32_t>(crc);
+    for (; size != 0; --size, ++data) {
+        crc32 = _mm_crc32_u8(crc32, static_cast<unsigned char>(*data));
+    }
+    return ~crc32;
+}
+
+bool detect_hw() {
+    return __builtin_cpu_supports("sse4.2");
+}
+#else
+std::uint32_t crc32c_hw(const char* data, std::size_t size) {
+    return crc32c_sw(data, size);
+}
+
+bool detect_hw() {
+    return false;
+}
+#endif
+
+const bool HW_AVAILABLE = detect_hw();
+
+} // namespace
+
+std::uint32_t crc32c_sw(const char* data, std::size_t size) {
+    std::uint32_t crc = 0xFFFFFFFFu;
+    for (; size >= 8; size -= 8, data += 8) {
+        std::uint32_t lo;
+        std::uint32_t hi;
+        std::memcpy(&lo, data, sizeof(lo));
+        std::memcpy(&hi, data + 4, sizeof(hi));
+        lo ^= crc;
+        crc = TABLES[7][lo & 0xffu] ^ TABLES[6][(lo >> 8) & 0xffu]
+            ^ TABLES[5][(lo >> 16) & 0xffu] ^ TABLES[4][lo >> 24]
+            ^ TABLES[3][hi & 0xffu] ^ TABLES[2][(hi >> 8) & 0xffu]
+            ^ TABLES[1][(hi >> 16) & 0xffu] ^ TABLES[0][hi >> 24];
+    }
+    for (; size != 0; --size, ++data) {
+        crc = (crc >> 8) ^ TABLES[0][(crc ^ static_cast<unsigned char>(*data)) & 0xffu];
+    }
+    return ~crc;
+}
+
+std::uint32_t crc32c(const char* data, std::size_t size) {
+    return HW_AVAILABLE ? crc32c_hw(data, size) : crc32c_sw(data, size);
+}
+
+bool crc32c_hw_available() {
+    return HW_AVAILABLE;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * CRC32C (Castagnoli) checksum.
+ * Uses SSE4.2 crc32 instruction if CPU supports it (checked once at runtime),
+ * otherwise falls back to the table-driven software implementation.
+ */
+std::uint32_t crc32c(const char* data, std::size_t size);
+
+/// software implementation, exported for tests and benchmarks
+std::uint32_t crc32c_sw(const char* data, std::size_t size);
+
+/// true if crc32c uses hardware instructions
+bool crc32c_hw_available();
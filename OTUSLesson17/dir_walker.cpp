@@ -0,0 +1,201 @@
+#include "dir_walker.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include <boost/filesystem.hpp>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+constexpr std::size_t DIRENT_BUFFER_SIZE = 64 * 1024;
+
+/// layout of records returned by getdents64
+struct LinuxDirent64 {
+    std::uint64_t d_ino;
+    std::int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+
+std::string join_path(const std::string& dir, const char* name) {
+    std::string res;
+    res.reserve(dir.size() + 1 + std::strlen(name));
+    res += dir;
+    if (res.empty() || res.back() != '/') {
+        res += '/';
+    }
+    res += name;
+    return res;
+}
+
+/// one statx call, mode is needed only for DT_UNKNOWN entries
+bool stat_at(int dir_fd, const char* name, FileStat& res, mode_t& mode) {
+    struct statx stx{};
+    if (::statx(dir_fd, name, AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT,
+                STATX_TYPE | STATX_SIZE | STATX_INO | STATX_MTIME, &stx) == 0)
+    {
+        res.dev = static_cast<std::uint64_t>(makedev(stx.stx_dev_major, stx.stx_dev_minor));
+        res.ino = stx.stx_ino;
+        res.size = stx.stx_size;
+        res.mtime_ns = static_cast<std::int64_t>(stx.stx_mtime.tv_sec) * 1'000'000'000
+                + static_cast<std::int64_t>(stx.stx_mtime.tv_nsec);
+        mode = stx.stx_mode;
+        return true;
+    }
+    if (errno != ENOSYS) {
+        return false;
+    }
+    // kernel without statx
+    struct stat st{};
+    if (::fstatat(dir_fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+        return false;
+    }
+    res.dev = static_cast<std::uint64_t>(st.st_dev);
+    res.ino = static_cast<std::uint64_t>(st.st_ino);
+    res.size = static_cast<std::uint64_t>(st.st_size);
+    res.mtime_ns = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1'000'000'000
+            + static_cast<std::int64_t>(st.st_mtim.tv_nsec);
+    mode = st.st_mode;
+    return true;
+}
+
+/// reads one directory: regular files go to files, subdirectories -- to dirs
+void scan_dir(const std::string& dir, std::vector<char>& buffer,
+        std::vector<std::string>& dirs, std::vector<FileRecord>& files)
+{
+    int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        cerr << "can't open directory " << dir << ": " << std::strerror(errno) << endl;
+        return;
+    }
+    for (;;) {
+        auto n = ::syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+        if (n <= 0) {
+            break;
+        }
+        for (long pos = 0; pos < n;) {
+            const auto* entry = reinterpret_cast<const LinuxDirent64*>(buffer.data() + pos);
+            pos += entry->d_reclen;
+            const char* name = entry->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+                continue;
+            }
+            if (entry->d_type == DT_DIR) {
+                dirs.push_back(join_path(dir, name));
+                continue;
+            }
+            if (entry->d_type != DT_REG && entry->d_type != DT_UNKNOWN) {
+                continue;
+            }
+            FileStat stat;
+            mode_t mode = 0;
+            if (!stat_at(fd, name, stat, mode)) {
+                continue;
+            }
+            if (S_ISREG(mode)) {
+                files.push_back({join_path(dir, name), stat});
+            } else if (S_ISDIR(mode)) {
+                dirs.push_back(join_path(dir, name));
+            }
+        }
+    }
+    ::close(fd);
+}
+
+} // namespace
+
+DirWalker::DirWalker(std::string root, std::size_t threads_num) {
+    dirs_.push_back(std::move(root));
+    threads_num = std::max<std::size_t>(threads_num, 1);
+    workers_.reserve(threads_num);
+    for (std::size_t i = 0; i < threads_num; ++i) {
+        workers_.emplace_back(&DirWalker::worker, this);
+    }
+}
+
+DirWalker::~DirWalker() {
+    {
+        std::lock_guard lk(mtx_);
+        stop_ = true;
+    }
+    dirs_cv_.notify_all();
+    for (auto& t : workers_) {
+        t.join();
+    }
+}
+
+void DirWalker::worker() {
+    std::vector<char> buffer(DIRENT_BUFFER_SIZE);
+    std::vector<std::string> dirs;
+    std::vector<FileRecord> files;
+    std::unique_lock lk(mtx_);
+    for (;;) {
+        dirs_cv_.wait(lk, [this]() {return stop_ || finished_ || !dirs_.empty();});
+        if (stop_ || finished_) {
+            return;
+        }
+        auto dir = std::move(dirs_.front());
+        dirs_.pop_front();
+        ++busy_workers_;
+        lk.unlock();
+
+        scan_dir(dir, buffer, dirs, files);
+
+        lk.lock();
+        --busy_workers_;
+        // depth-first order keeps the queue short on wide trees
+        for (auto& d : dirs) {
+            dirs_.push_front(std::move(d));
+        }
+        dirs.clear();
+        if (!files.empty()) {
+            batches_.push_back(std::move(files));
+            files = {};
+            files_cv_.notify_one();
+        }
+        if (dirs_.empty() && busy_workers_ == 0) {
+            finished_ = true;
+            files_cv_.notify_all();
+            dirs_cv_.notify_all();
+        } else {
+            dirs_cv_.notify_all();
+        }
+    }
+}
+
+boost::optional<FileRecord> DirWalker::next() {
+    if (current_pos_ == current_batch_.size()) {
+        std::unique_lock lk(mtx_);
+        files_cv_.wait(lk, [this]() {return finished_ || !batches_.empty();});
+        if (batches_.empty()) {
+            return boost::none;
+        }
+        current_batch_ = std::move(batches_.front());
+        batches_.pop_front();
+        current_pos_ = 0;
+    }
+    return std::move(current_batch_[current_pos_++]);
+}
+
+std::vector<std::string> getFileListRecursive(const std::string& path_name, std::size_t threads_num) {
+    namespace fs = boost::filesystem;
+    auto root = path_name.empty() ? fs::current_path().string() : path_name;
+    vector<string> res;
+    DirWalker walker(root, threads_num);
+    while (auto rec = walker.next()) {
+        res.push_back(std::move(rec->path));
+    }
+    return res;
+}
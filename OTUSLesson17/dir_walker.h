@@ -0,0 +1,59 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "file_utils.h"
+
+/// regular file found by the walker
+struct FileRecord {
+    std::string path;
+    FileStat stat;
+};
+
+/**
+ * Parallel recursive directory walker.
+ *
+ * Worker threads take directories from the shared queue, read them with getdents64
+ * and use d_type to tell files from directories without stat. Every regular file gets
+ * one statx call (size, inode, mtime), subdirectories are pushed back to the queue.
+ * Symlinks aren't followed and aren't reported.
+ *
+ * Walk starts in constructor, records are streamed through next(), so consumer
+ * can process them while the walk is in progress. Order of records isn't specified.
+ */
+class DirWalker {
+public:
+    DirWalker(std::string root, std::size_t threads_num);
+    ~DirWalker();
+    DirWalker(const DirWalker&) = delete;
+    DirWalker& operator=(const DirWalker&) = delete;
+
+    /// next found file, blocks until it's found, boost::none if the walk is finished
+    boost::optional<FileRecord> next();
+
+private:
+    std::mutex mtx_;
+    std::condition_variable dirs_cv_;
+    std::condition_variable files_cv_;
+    std::deque<std::string> dirs_;
+    std::size_t busy_workers_ = 0;
+    bool finished_ = false;
+    bool stop_ = false;
+    std::deque<std::vector<FileRecord>> batches_;
+    std::vector<FileRecord> current_batch_;
+    std::size_t current_pos_ = 0;
+    std::vector<std::thread> workers_;
+
+    void worker();
+};
+
+/// all regular files of the directory tree (current directory if path_name is empty)
+std::vector<std::string> getFileListRecursive(const std::string& path_name, std::size_t threads_num = 1);
@@ -3,6 +3,12 @@
 #include <boost/move/utility.hpp>
 #include <boost/unordered_map.hpp>
 
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <string_view>
+#include <utility>
+
 //# define TEST
 
 #ifdef TEST
@@ -15,54 +21,280 @@ CompareFiles::DuplicateList CompareFiles::compare(const std::vector<std::string>
     if (files.size() < 2) {
         return {};
     }
+    auto it = files.begin();
+    return compare_records([&it, &files]() -> boost::optional<FileRecord> {
+        while (it != files.end()) {
+            const auto& fname = *it++;
+            if (auto stat = get_file_stat(fname)) {
+                return FileRecord{fname, *stat};
+            }
+        }
+        return boost::none;
+    });
+}
 
-    boost::unordered_map<size_t,
-        boost::container::vector<pair<int, FileHasher>>> size_to_filehash{};
+CompareFiles::DuplicateList CompareFiles::compare(DirWalker& walker) {
+    return compare_records([&walker]() {return walker.next();});
+}
+
+CompareFiles::DuplicateList CompareFiles::compare_records(const RecordSource& next_record) {
+    // Algo (staged grouping):
+    // stage 0: names of the same inode (hardlinks) are one file, they are duplicates without reading
+    // stage 1: group files by size (no reading at all), sizes come with the records,
+    //          files of unique size are never opened
+    // stage 2: split every group by hash of block 0, then subgroups by hash of block 1 etc.
+    //          (the last block goes right after the first one in first-last mode)
+    //          groups with one file are dropped, so every block is read at most once
+    //          and only while its group has more than one file.
+    //          Groups of tiny files are split by content, every file is read once without hashing
+    Files files;
+    // file stats for the cache, stat is done before reading, so changes during reading
+    // make the stored entry invalid for the next run
+    std::vector<FileStat> stats{};
+    boost::unordered_map<std::pair<std::uint64_t, std::uint64_t>, size_t> inode_to_file{};
+    boost::unordered_map<size_t, size_t> size_to_group{};
+    boost::container::vector<FileGroup> size_groups{};
     DuplicateGroup empty_files{};
-    DuplicateList duplicates{};
+    std::size_t files_count = 0;
 
-    for (const auto& cur_fname : files) {
+    while (auto record = next_record()) {
 #ifdef TEST
-        cerr << cur_fname << endl;
+        cerr << record->path << endl;
 #endif
-        FileHasher cur_fh(cur_fname, block_size_, hasher_);
-        // file is empty
-        auto cur_size = cur_fh.getFileSize();
+        ++files_count;
+        auto cur_size = static_cast<std::size_t>(record->stat.size);
         if (cur_size == 0) {
-            empty_files.insert(cur_fname);
+            empty_files.insert(std::move(record->path));
             continue;
         }
-        // Algo:
-        // select filehashes with the same size
-        // and compare with them
-        // if true: add to duplicates
-        // add cur file_hash to size_to_filehash if unique
-        constexpr int NOT_IN_GROUP = -1;
-        auto& file_hashers =  size_to_filehash[cur_size];
-        bool isFound = false;
-        for (auto& [group_idx, fh] : file_hashers) {
-            if (cur_fh == fh) {
-                if (group_idx != NOT_IN_GROUP) {
-                    duplicates[group_idx].insert(cur_fname);
-                } else {
-                    group_idx = duplicates.size();
-                    duplicates.push_back({fh.getFileName(), cur_fname});
-                }
-                isFound = true;
-                break;
+        auto [inode_it, new_inode] = inode_to_file.try_emplace(
+                std::make_pair(record->stat.dev, record->stat.ino), files.hashers.size());
+        if (!new_inode) {
+            files.aliases[inode_it->second].push_back(std::move(record->path));
+            continue;
+        }
+        files.hashers.emplace_back(std::move(record->path), cur_size, layout_, hasher_, read_mode_);
+        files.aliases.emplace_back();
+        stats.push_back(record->stat);
+        auto [it, inserted] = size_to_group.try_emplace(cur_size, size_groups.size());
+        if (inserted) {
+            size_groups.emplace_back();
+        }
+        size_groups[it->second].push_back(files.hashers.size() - 1);
+    }
+    if (files_count < 2) {
+        return {};
+    }
+
+    DuplicateList duplicates{};
+    boost::container::vector<FileGroup> groups{};
+    boost::container::vector<FileGroup> tiny_groups{};
+    for (auto& group : size_groups) {
+        if (group.size() < 2) {
+            add_aliases(files, group.front(), duplicates);
+            continue;
+        }
+        auto file_size = files.hashers[group.front()].getFileSize();
+        if (file_size <= layout_.blockSize(0) && file_size <= MAX_TINY_FILE_SIZE) {
+            // tiny files are compared by content, block hashes aren't used
+            tiny_groups.push_back(std::move(group));
+            continue;
+        }
+        if (cache_) {
+            for (auto idx : group) {
+                files.hashers[idx].preloadBlocks(cache_->lookup(stats[idx]));
             }
         }
-        if (!isFound) {
-            file_hashers.emplace_back(NOT_IN_GROUP, (move(cur_fh)));
+        groups.push_back(std::move(group));
+    }
+    split_tiny_groups(files, std::move(tiny_groups), duplicates);
+    split_groups(files, std::move(groups), duplicates);
+    if (cache_) {
+        for (std::size_t i = 0; i < stats.size(); ++i) {
+            const auto& hasher = files.hashers[i];
+            cache_->store(stats[i], hasher.getBlockHashes(), hasher.getReadBlocksCount());
         }
     }
-    // add empty file list
-    if (!empty_files.empty()) {
+    // add empty file list, one empty file isn't a duplicate
+    if (empty_files.size() > 1) {
         duplicates.push_back(boost::move(empty_files));
     }
     return duplicates;
 }
 
+std::size_t CompareFiles::block_for_step(std::size_t step, std::size_t blocks_count) const {
+    if (!first_last_ || blocks_count < 3 || step == 0) {
+        return step;
+    }
+    // 0, last, 1, 2, ..., last - 1
+    return step == 1 ? blocks_count - 1 : step - 1;
+}
+
+void CompareFiles::split_groups(Files& files, boost::container::vector<FileGroup> groups,
+        DuplicateList& duplicates)
+{
+    // groups are processed in waves: the next block of every file of every active group
+    // is read (in parallel if pool_ exists), then groups are split by block hashes.
+    // Waves don't depend on the threads number, so the result doesn't depend on it too
+    auto& hashers = files.hashers;
+    std::deque<GroupState> pending{};
+    for (auto& group : groups) {
+        pending.emplace_back(std::move(group), 0);
+    }
+    std::vector<GroupState> active{};
+    std::size_t active_files = 0;
+
+    while (!pending.empty() || !active.empty()) {
+        while (!pending.empty()
+               && (active.empty() || active_files + pending.front().first.size() <= MAX_ACTIVE_FILES))
+        {
+            active_files += pending.front().first.size();
+            active.push_back(std::move(pending.front()));
+            pending.pop_front();
+        }
+
+        // (file index, block number)
+        std::vector<std::pair<std::size_t, std::size_t>> blocks{};
+        blocks.reserve(active_files);
+        for (const auto& [group, step] : active) {
+            const auto blocks_count = layout_.blocksCount(hashers[group.front()].getFileSize());
+            for (auto idx : group) {
+                blocks.emplace_back(idx, block_for_step(step, blocks_count));
+            }
+        }
+        // every file is used only by one task, so FileHashers are not shared between threads
+        std::vector<boost::optional<Hash>> hashes(blocks.size());
+        run_tasks(blocks.size(), [&hashers, &blocks, &hashes](std::size_t i) {
+            hashes[i] = hashers[blocks[i].first].readBlock(blocks[i].second);
+        });
+
+        std::vector<GroupState> next_active{};
+        active_files = 0;
+        auto hash_it = hashes.begin();
+        for (auto& [group, step] : active) {
+            const auto blocks_count = layout_.blocksCount(hashers[group.front()].getFileSize());
+            // split by hash of the block, subgroups keep files order
+            boost::unordered_map<Hash, size_t> hash_to_subgroup{};
+            boost::container::vector<FileGroup> subgroups{};
+            for (auto idx : group) {
+                auto hash = *hash_it++;
+                if (!hash) {
+                    hashers[idx].closeBlockFile();
+                    add_aliases(files, idx, duplicates);
+                    continue;
+                }
+                auto [it, inserted] = hash_to_subgroup.try_emplace(*hash, subgroups.size());
+                if (inserted) {
+                    subgroups.emplace_back();
+                }
+                subgroups[it->second].push_back(idx);
+            }
+            for (auto& subgroup : subgroups) {
+                if (subgroup.size() < 2) {
+                    hashers[subgroup.front()].closeBlockFile();
+                    add_aliases(files, subgroup.front(), duplicates);
+                } else if (step + 1 == blocks_count) {
+                    add_duplicates(files, subgroup, duplicates);
+                } else {
+                    active_files += subgroup.size();
+                    next_active.emplace_back(std::move(subgroup), step + 1);
+                }
+            }
+        }
+        active = std::move(next_active);
+    }
+}
+
+void CompareFiles::split_tiny_groups(Files& files, boost::container::vector<FileGroup> groups,
+        DuplicateList& duplicates)
+{
+    // whole contents of tiny files are compared directly: one read per file, no hashing.
+    // Groups are processed in waves of MAX_ACTIVE_FILES files to bound the memory
+    auto& hashers = files.hashers;
+    std::size_t next_group = 0;
+    while (next_group < groups.size()) {
+        std::vector<std::size_t> wave_files{};
+        auto first_group = next_group;
+        while (next_group < groups.size()
+               && (wave_files.empty() || wave_files.size() + groups[next_group].size() <= MAX_ACTIVE_FILES))
+        {
+            wave_files.insert(wave_files.end(), groups[next_group].begin(), groups[next_group].end());
+            ++next_group;
+        }
+        std::vector<boost::optional<std::string>> contents(wave_files.size());
+        run_tasks(wave_files.size(), [&hashers, &wave_files, &contents](std::size_t i) {
+            contents[i] = hashers[wave_files[i]].readContent();
+            hashers[wave_files[i]].closeBlockFile();
+        });
+
+        auto content_it = contents.begin();
+        for (auto g = first_group; g < next_group; ++g) {
+            boost::unordered_map<std::string_view, size_t> content_to_subgroup{};
+            boost::container::vector<FileGroup> subgroups{};
+            for (auto idx : groups[g]) {
+                const auto& content = *content_it++;
+                if (!content) {
+                    add_aliases(files, idx, duplicates);
+                    continue;
+                }
+                auto [it, inserted] = content_to_subgroup.try_emplace(*content, subgroups.size());
+                if (inserted) {
+                    subgroups.emplace_back();
+                }
+                subgroups[it->second].push_back(idx);
+            }
+            for (const auto& subgroup : subgroups) {
+                if (subgroup.size() < 2) {
+                    add_aliases(files, subgroup.front(), duplicates);
+                } else {
+                    add_duplicates(files, subgroup, duplicates);
+                }
+            }
+        }
+    }
+}
+
+void CompareFiles::run_tasks(std::size_t count, const std::function<void(std::size_t)>& task) {
+    if (!pool_) {
+        for (std::size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+    std::vector<std::future<void>> futures{};
+    futures.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        futures.push_back(pool_->submit([&task, i]() {task(i);}));
+    }
+    for (auto& f : futures) {
+        f.get();
+    }
+}
+
+void CompareFiles::add_duplicates(Files& files, const FileGroup& group, DuplicateList& duplicates) {
+    DuplicateGroup dup_group{};
+    for (auto idx : group) {
+        dup_group.insert(files.hashers[idx].getFileName());
+        files.hashers[idx].closeBlockFile();
+        for (auto& alias : files.aliases[idx]) {
+            dup_group.insert(std::move(alias));
+        }
+    }
+    duplicates.push_back(boost::move(dup_group));
+}
+
+void CompareFiles::add_aliases(Files& files, std::size_t idx, DuplicateList& duplicates) {
+    if (files.aliases[idx].empty()) {
+        return;
+    }
+    DuplicateGroup dup_group{};
+    dup_group.insert(files.hashers[idx].getFileName());
+    for (auto& alias : files.aliases[idx]) {
+        dup_group.insert(std::move(alias));
+    }
+    duplicates.push_back(boost::move(dup_group));
+}
+
 
 std::ostream& operator<<(std::ostream& out, const CompareFiles::DuplicateList& dupList) {
     bool is_first = true;
@@ -2,23 +2,84 @@
 
 #include <string>
 #include <vector>
+#include <memory>
+#include <boost/optional.hpp>
 #include <boost/unordered_set.hpp>
 #include <boost/container/vector.hpp>
+#include <functional>
 #include <iostream>
 
+#include "dir_walker.h"
 #include "file_hasher.h"
+#include "hash_cache.h"
 #include "hasher.h"
+#include "thread_pool.h"
 
 class CompareFiles {
 public:
     using DuplicateGroup = boost::unordered_set<std::string>;
     using DuplicateList = boost::container::vector<DuplicateGroup>;
-    explicit CompareFiles(std::size_t block_size, IHasher& hasher)
-        : block_size_(block_size), hasher_(hasher) {}
+    /// threads_num > 1 -- blocks are read and hashed on the thread pool, result doesn't depend on it
+    explicit CompareFiles(const BlockLayout& layout, IHasher& hasher, std::size_t threads_num = 1,
+            ReadMode read_mode = ReadMode::Pread)
+        : layout_(layout), hasher_(hasher), read_mode_(read_mode)
+    {
+        if (threads_num > 1) {
+            pool_ = std::make_unique<ThreadPool>(threads_num);
+        }
+    }
+    /// fixed block size
+    explicit CompareFiles(std::size_t block_size, IHasher& hasher, std::size_t threads_num = 1,
+            ReadMode read_mode = ReadMode::Pread)
+        : CompareFiles(BlockLayout::fixed(block_size), hasher, threads_num, read_mode)
+    {}
+    /// block hashes are taken from and stored to the cache, it must outlive compare calls
+    void useHashCache(HashCache& cache) {cache_ = &cache;}
+    /// compare the first and the last blocks before the others
+    /// (files which differ only at the end are rejected early)
+    void setFirstLastMode(bool first_last) {first_last_ = first_last;}
     DuplicateList compare(const std::vector<std::string>& files);
+    /// files are grouped by size while the walker is still walking
+    DuplicateList compare(DirWalker& walker);
 private:
-    std::size_t block_size_ = 1;
+    /// indexes of files with the same size (and the same processed blocks)
+    using FileGroup = boost::container::vector<std::size_t>;
+    /// group and number of the next comparison step (see block_for_step)
+    using GroupState = std::pair<FileGroup, std::size_t>;
+    /// limit of simultaneously processed (and opened) files
+    static constexpr std::size_t MAX_ACTIVE_FILES = 512;
+    /// files of one block up to this size are compared by content without hashing
+    static constexpr std::size_t MAX_TINY_FILE_SIZE = 64 * 1024;
+
+    /// files being compared, hardlinks are one file with several names
+    struct Files {
+        boost::container::vector<FileHasher> hashers;
+        /// other names (hardlinks) of hashers[i]
+        std::vector<std::vector<std::string>> aliases;
+    };
+
+    BlockLayout layout_;
     IHasher& hasher_;
+    ReadMode read_mode_ = ReadMode::Pread;
+    std::unique_ptr<ThreadPool> pool_;
+    HashCache* cache_ = nullptr;
+    bool first_last_ = false;
+
+    /// source of files, boost::none is the end
+    using RecordSource = std::function<boost::optional<FileRecord>()>;
+
+    DuplicateList compare_records(const RecordSource& next_record);
+    void split_groups(Files& files, boost::container::vector<FileGroup> groups,
+            DuplicateList& duplicates);
+    void split_tiny_groups(Files& files, boost::container::vector<FileGroup> groups,
+            DuplicateList& duplicates);
+    std::size_t block_for_step(std::size_t step, std::size_t blocks_count) const;
+    /// runs task(0..count-1) on the pool (or inline if there is no pool)
+    void run_tasks(std::size_t count, const std::function<void(std::size_t)>& task);
+    /// reports group of files with all their names
+    static void add_duplicates(Files& files, const FileGroup& group, DuplicateList& duplicates);
+    /// file without duplicates, but its hardlinks are duplicates of each other
+    static void add_aliases(Files& files, std::size_t idx, DuplicateList& duplicates);
 };
 
 std::ostream& operator<<(std::ostream& out, const CompareFiles::DuplicateList& dupList);
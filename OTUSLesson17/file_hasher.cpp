@@ -2,68 +2,53 @@
 
 using namespace std;
 
-// Block File
-
-void FileHasher::BlockFile::open() {
-    if (!in_.is_open()) {
-        in_.rdbuf()->pubsetbuf(nullptr, 0);
-        in_.open(filename_, std::ios::binary | std::ios_base::in);
-    }
-}
-
-void FileHasher::BlockFile::close() {
-    if (in_.is_open()) {
-        in_.close();
-        readed_blocks_ = 0;
-    }
-}
-
-void FileHasher::BlockFile::shift(std::size_t blocks_num) {
-    if (blocks_num > readed_blocks_) {
-        std::size_t new_pos = (blocks_num - readed_blocks_) * block_size_;
-        in_.seekg(new_pos);
-        readed_blocks_ = blocks_num;
-    }
-}
-
-FileHasher::Block FileHasher::BlockFile::read() {
-    Block b(block_size_);
-    std::fill(b.begin(), b.end(), 0);
-    if ((readed_blocks_ + 1) * block_size_ <= file_size_) {
-        in_.read(b.data(), block_size_);
-    } else {
-        size_t to_read_size = file_size_ > readed_blocks_ * block_size_ ?
-                file_size_ - readed_blocks_ * block_size_
-                : 0;
-        in_.read(b.data(), to_read_size);
-    }
-    ++readed_blocks_;
-    return b;
-}
-
-
-
 // FileHasher
 boost::optional<Hash> FileHasher::readBlock(std::size_t block_num) {
     if (block_num < blocks_cache_.size()) {
         return blocks_cache_[block_num];
     }
-    if (block_num * block_size_ >= getFileSize() || !bfile_.is_valid()) {
+    if (layout_.blockOffset(block_num) >= getFileSize()) {
         return boost::none;
     }
 
-    openBlockFile();
-    bfile_.shift(blocks_cache_.size());
-    //blocks_cache_.reserve(block_num + 1);
-    while (blocks_cache_.size() <= block_num && bfile_.is_valid()) {
-        blocks_cache_.push_back(hasher_(bfile_.read()));
+    if (block_num > blocks_cache_.size()) {
+        // out of order block (e.g. the last one in first-last mode),
+        // it's read alone and isn't added to the prefix of blocks
+        for (const auto& [num, hash] : sparse_blocks_) {
+            if (num == block_num) {
+                return hash;
+            }
+        }
+        auto block = source_->read(layout_.blockOffset(block_num),
+                layout_.readSize(block_num, file_size_));
+        if (!block) {
+            return boost::none;
+        }
+        sparse_blocks_.emplace_back(block_num, hasher_(*block));
+        return sparse_blocks_.back().second;
     }
 
-    if (block_num < blocks_cache_.size()) {
-        return blocks_cache_[block_num];
-    } else {
+    auto block = source_->read(layout_.blockOffset(block_num),
+            layout_.readSize(block_num, file_size_));
+    if (!block) {
+        return boost::none;
+    }
+    blocks_cache_.push_back(hasher_(*block));
+    return blocks_cache_.back();
+}
+
+boost::optional<std::string> FileHasher::readContent() {
+    if (file_size_ > layout_.blockSize(0)) {
+        throw logic_error("readContent is only for files of one block");
+    }
+    if (file_size_ == 0) {
+        return std::string{};
+    }
+    auto block = source_->read(0, layout_.readSize(0, file_size_));
+    if (!block) {
         return boost::none;
     }
+    return std::string(block->data(), file_size_);
 }
 
 boost::optional<Hash> FileHasher::operator[](std::size_t idx) {
@@ -71,7 +56,7 @@ boost::optional<Hash> FileHasher::operator[](std::size_t idx) {
 }
 
 std::size_t FileHasher::getFileSize() const {
-    return bfile_.getFileSize();
+    return file_size_;
 }
 
 bool operator==(FileHasher &lhs, FileHasher &rhs) {
@@ -1,51 +1,32 @@
 #pragma once
 
 #include <string>
-#include <fstream>
+#include <utility>
 #include <vector>
 #include <boost/optional.hpp>
 
 #include "hasher.h"
+#include "block_layout.h"
+#include "block_source.h"
 #include "file_utils.h"
 
 using namespace std;
 
 class FileHasher {
-    using Block = std::vector<char>;
-
-    class BlockFile {
-    public:
-        BlockFile(std::string filename, std::size_t block_size)
-            : filename_(std::move(filename)), block_size_(block_size)
-        {
-            file_size_ = get_file_size(filename_);
-        }
-
-        void open();
-        void close();
-
-        bool is_valid() const { return static_cast<bool>(in_);}
-        void shift(std::size_t blocks_num);
-        Block read();
-        // getters
-        const std::string& getFileName() const {return filename_;}
-        std::size_t getFileSize() const { return file_size_;}
-    private:
-        std::string filename_;
-        std::size_t block_size_ = 0;
-        std::size_t file_size_ = 0;
-        std::ifstream in_;
-        std::size_t readed_blocks_ = 0;
-    };
-
 public:
-    explicit FileHasher(std::string filename, std::size_t block_size, IHasher& hasher)
-        : block_size_(block_size), hasher_(hasher),
-        bfile_(std::move(filename), block_size)
+    explicit FileHasher(std::string filename, std::size_t block_size, IHasher& hasher,
+            ReadMode read_mode = ReadMode::Pread)
+        : filename_(std::move(filename)), layout_(BlockLayout::fixed(block_size)), hasher_(hasher)
     {
-        if (block_size_ == 0) {
-            throw invalid_argument("Block size can't be zero");
-        }
+        file_size_ = get_file_size(filename_);
+        source_ = makeBlockSource(read_mode, filename_, file_size_, layout_.maxBlockSize());
+    }
+    /// file size is already known (e.g. from directory walk), file isn't touched until reading
+    FileHasher(std::string filename, std::size_t file_size, const BlockLayout& layout, IHasher& hasher,
+            ReadMode read_mode = ReadMode::Pread)
+        : filename_(std::move(filename)), layout_(layout), file_size_(file_size), hasher_(hasher)
+    {
+        source_ = makeBlockSource(read_mode, filename_, file_size_, layout_.maxBlockSize());
     }
     FileHasher(const FileHasher&) = delete;
     FileHasher(FileHasher&&) = default;
@@ -53,21 +34,39 @@ public:
     FileHasher& operator=(FileHasher&&) = delete; // because of IHasher&
     // access
     boost::optional<Hash> operator[](std::size_t idx);
+    /// blocks are cached, so every block is read at most once
     boost::optional<Hash> readBlock(std::size_t block_num);
+    /// whole content of the file which isn't bigger than one block, for direct comparison
+    boost::optional<std::string> readContent();
     // getters
-    [[nodiscard]] const std::string& getFileName() const {return bfile_.getFileName();}
+    [[nodiscard]] const std::string& getFileName() const {return filename_;}
     std::size_t getFileSize() const;
-    void openBlockFile() {
-        bfile_.open();
-    }
     void closeBlockFile() {
-        bfile_.close();
+        source_->close();
+    }
+    // persistent cache support
+    /// sets already known hashes of the first blocks, they won't be read from file
+    void preloadBlocks(std::vector<Hash> hashes) {
+        if (blocks_cache_.empty()) {
+            blocks_cache_ = std::move(hashes);
+            preloaded_blocks_ = blocks_cache_.size();
+        }
+    }
+    [[nodiscard]] const std::vector<Hash>& getBlockHashes() const {return blocks_cache_;}
+    /// number of blocks which were read from file (not preloaded)
+    [[nodiscard]] std::size_t getReadBlocksCount() const {
+        return blocks_cache_.size() - preloaded_blocks_;
     }
 private:
-    std::size_t block_size_ = 1;
+    std::string filename_;
+    BlockLayout layout_;
+    std::size_t file_size_ = 0;
     std::vector<Hash> blocks_cache_;
+    std::size_t preloaded_blocks_ = 0;
+    /// blocks read out of order, there are few of them
+    std::vector<std::pair<std::size_t, Hash>> sparse_blocks_;
     IHasher& hasher_;
-    BlockFile bfile_;
+    BlockSourceHolder source_;
 };
 
 bool operator==(FileHasher& lhs, FileHasher& rhs);
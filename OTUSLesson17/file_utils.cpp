@@ -5,6 +5,8 @@
 #include <iostream>
 #include <boost/sort/spreadsort/string_sort.hpp>
 
+#include <sys/stat.h>
+
 using namespace std;
 namespace fs = boost::filesystem;
 
@@ -28,28 +30,21 @@ void sort_names_and_remove_duplic(std::vector<std::string>& files) {
     files.erase(unique(files.begin(), files.end()), files.end());
 }
 
-std::vector<std::string> getFileListRecursive(const std::string& path_name) {
-    fs::path parent_path;
-    if (!path_name.empty()) {
-        if (!fs::exists(path_name)) return {};
-        parent_path = fs::path(path_name);
-    } else {
-        parent_path = fs::current_path();
-    }
-    vector<string> res;
-    try {
-        for (const auto& p : fs::recursive_directory_iterator(parent_path)) {
-            if (fs::is_regular_file(p.path())) {
-                res.push_back(p.path().string());
-            }
-        }
-    } catch (const exception& e) {
-        cerr << e.what() << " " << res.back() << endl;
-        return res;
+std::size_t get_file_size(const std::string& filename) {
+    return fs::file_size(fs::path(filename));
+}
+
+boost::optional<FileStat> get_file_stat(const std::string& filename) {
+    struct stat st{};
+    // symlinks aren't followed (like in DirWalker): a link next to its target isn't a duplicate
+    if (::lstat(filename.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        return boost::none;
     }
+    FileStat res;
+    res.dev = static_cast<std::uint64_t>(st.st_dev);
+    res.ino = static_cast<std::uint64_t>(st.st_ino);
+    res.size = static_cast<std::uint64_t>(st.st_size);
+    res.mtime_ns = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1'000'000'000
+            + static_cast<std::int64_t>(st.st_mtim.tv_nsec);
     return res;
 }
-
-std::size_t get_file_size(const std::string& filename) {
-    return fs::file_size(fs::path(filename));
-}
\ No newline at end of file
@@ -1,10 +1,22 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include <string>
 
+#include <boost/optional.hpp>
+
+/// file identity and version, file is considered unchanged while all fields are the same
+struct FileStat {
+    std::uint64_t dev = 0;
+    std::uint64_t ino = 0;
+    std::uint64_t size = 0;
+    std::int64_t mtime_ns = 0;
+};
+
 void make_full_paths(std::vector<std::string>& files);
 void remove_non_valid_paths(std::vector<std::string>& files);
 void sort_names_and_remove_duplic(std::vector<std::string>& files);
-std::vector<std::string> getFileListRecursive(const std::string& path_name);
-std::size_t get_file_size(const std::string& filename);
\ No newline at end of file
+std::size_t get_file_size(const std::string& filename);
+/// lstat(2) of the regular file, boost::none if it can't be done or it isn't a regular file (symlink, directory...)
+boost::optional<FileStat> get_file_stat(const std::string& filename);
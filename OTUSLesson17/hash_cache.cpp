@@ -0,0 +1,188 @@
+#include "hash_cache.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+#include <tuple>
+
+using namespace std;
+
+namespace {
+
+constexpr std::uint32_t CACHE_MAGIC = 0x434e5942; // "BYNC"
+constexpr std::uint32_t CACHE_VERSION = 1;
+
+/// on-disk record header, it's followed by hashes_count pairs of uint64 (low, high)
+struct RecordHeader {
+    std::uint64_t dev = 0;
+    std::uint64_t ino = 0;
+    std::uint64_t size = 0;
+    std::int64_t mtime_ns = 0;
+    std::uint64_t layout_id = 0;
+    std::uint32_t hash_type = 0;
+    std::uint32_t hashes_count = 0;
+};
+
+template <typename T>
+bool read_raw(istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+template <typename T>
+void write_raw(ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+} // namespace
+
+bool operator==(const HashCache::Key& lhs, const HashCache::Key& rhs) {
+    return std::tie(lhs.dev, lhs.ino, lhs.size, lhs.mtime_ns, lhs.layout_id, lhs.hash_type)
+        == std::tie(rhs.dev, rhs.ino, rhs.size, rhs.mtime_ns, rhs.layout_id, rhs.hash_type);
+}
+
+std::size_t hash_value(const HashCache::Key& key) {
+    std::size_t seed = 0;
+    boost::hash_combine(seed, key.dev);
+    boost::hash_combine(seed, key.ino);
+    boost::hash_combine(seed, key.size);
+    boost::hash_combine(seed, key.mtime_ns);
+    boost::hash_combine(seed, key.layout_id);
+    boost::hash_combine(seed, key.hash_type);
+    return seed;
+}
+
+HashCache::HashCache(std::string filename, std::uint64_t layout_id, HashType hash_type)
+    : filename_(std::move(filename)), layout_id_(layout_id), hash_type_(hash_type)
+{
+    using namespace std::chrono;
+    auto now = duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+    racy_after_ns_ = static_cast<std::int64_t>(now) - 1'000'000'000;
+    load();
+}
+
+HashCache::Key HashCache::make_key(const FileStat& stat) const {
+    return {stat.dev, stat.ino, stat.size, stat.mtime_ns, layout_id_,
+            static_cast<std::uint32_t>(hash_type_)};
+}
+
+std::vector<Hash> HashCache::lookup(const FileStat& stat) {
+    std::lock_guard lk(mtx_);
+    auto it = entries_.find(make_key(stat));
+    if (it == entries_.end()) {
+        ++stats_.files_missed;
+        return {};
+    }
+    ++stats_.files_hit;
+    return it->second;
+}
+
+void HashCache::store(const FileStat& stat, const std::vector<Hash>& hashes, std::size_t blocks_read) {
+    std::lock_guard lk(mtx_);
+    stats_.blocks_cached += hashes.size() - blocks_read;
+    stats_.blocks_read += blocks_read;
+    if (blocks_read == 0 || stat.mtime_ns >= racy_after_ns_) {
+        return;
+    }
+    entries_[make_key(stat)] = hashes;
+    changed_ = true;
+}
+
+void HashCache::load() {
+    ifstream in(filename_, ios::binary);
+    if (!in) {
+        return;
+    }
+    std::uint32_t magic = 0;
+    std::uint32_t version = 0;
+    if (!read_raw(in, magic) || !read_raw(in, version)
+        || magic != CACHE_MAGIC || version != CACHE_VERSION)
+    {
+        // unknown format, it'll be overwritten on save
+        changed_ = true;
+        return;
+    }
+    in.seekg(0, ios::end);
+    auto file_size = static_cast<std::uint64_t>(in.tellg());
+    in.seekg(sizeof(magic) + sizeof(version));
+    constexpr std::uint64_t HASH_SIZE = sizeof(Hash::low) + sizeof(Hash::high);
+    RecordHeader rec;
+    while (read_raw(in, rec)) {
+        // corrupted count mustn't allocate more than the rest of the file
+        auto rest = file_size - static_cast<std::uint64_t>(in.tellg());
+        if (rec.hashes_count > rest / HASH_SIZE) {
+            changed_ = true;
+            break;
+        }
+        std::vector<Hash> hashes(rec.hashes_count);
+        bool ok = true;
+        for (auto& h : hashes) {
+            ok = read_raw(in, h.low) && read_raw(in, h.high);
+            if (!ok) break;
+        }
+        if (!ok) {
+            // truncated tail (e.g. disk is full), drop the last record
+            changed_ = true;
+            break;
+        }
+        // later records override earlier ones
+        entries_[Key{rec.dev, rec.ino, rec.size, rec.mtime_ns, rec.layout_id, rec.hash_type}]
+                = std::move(hashes);
+    }
+}
+
+void HashCache::save() {
+    std::lock_guard lk(mtx_);
+    if (!changed_) {
+        return;
+    }
+    // entries with other inode/size/mtime of the same file are stale, the last one is kept
+    boost::unordered_map<std::tuple<std::uint64_t, std::uint64_t, std::uint64_t, std::uint32_t>,
+            const std::pair<const Key, std::vector<Hash>>*> live;
+    for (const auto& entry : entries_) {
+        const auto& key = entry.first;
+        auto [it, inserted] = live.try_emplace(
+                std::make_tuple(key.dev, key.ino, key.layout_id, key.hash_type), &entry);
+        if (!inserted && it->second->first.mtime_ns < key.mtime_ns) {
+            it->second = &entry;
+        }
+    }
+
+    auto tmp_filename = filename_ + ".tmp";
+    {
+        ofstream out(tmp_filename, ios::binary | ios::trunc);
+        if (!out) {
+            throw runtime_error("can't write hash cache: " + tmp_filename);
+        }
+        write_raw(out, CACHE_MAGIC);
+        write_raw(out, CACHE_VERSION);
+        for (const auto& [id, entry] : live) {
+            const auto& [key, hashes] = *entry;
+            RecordHeader rec{key.dev, key.ino, key.size, key.mtime_ns, key.layout_id, key.hash_type,
+                             static_cast<std::uint32_t>(hashes.size())};
+            write_raw(out, rec);
+            for (const auto& h : hashes) {
+                write_raw(out, h.low);
+                write_raw(out, h.high);
+            }
+        }
+        out.flush();
+        if (!out) {
+            std::remove(tmp_filename.c_str());
+            throw runtime_error("can't write hash cache: " + tmp_filename);
+        }
+    }
+    if (std::rename(tmp_filename.c_str(), filename_.c_str()) != 0) {
+        std::remove(tmp_filename.c_str());
+        throw runtime_error("can't replace hash cache: " + filename_);
+    }
+    changed_ = false;
+}
+
+std::ostream& operator<<(std::ostream& out, const HashCache::Stats& stats) {
+    return out << "hash cache: " << stats.files_hit << " files hit, "
+               << stats.files_missed << " files missed, "
+               << stats.blocks_cached << " blocks from cache, "
+               << stats.blocks_read << " blocks read";
+}
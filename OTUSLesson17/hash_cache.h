@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+#include <boost/unordered_map.hpp>
+
+#include "file_utils.h"
+#include "hasher.h"
+
+/**
+ * Persistent cache of block hashes between bayan runs.
+ *
+ * Entry key is (device, inode, size, mtime, block layout, hash type), so any change of the file
+ * or of the run parameters makes its entry invisible and the file is read again.
+ * Entries store the prefix of block hashes computed so far, later runs extend it.
+ *
+ * File is a log of records, it's read on load and rewritten (compacted) on save
+ * through a temporary file and rename, so it's never left half-written.
+ * Files modified in the last second before the run aren't stored: mtime of such
+ * file can stay the same after one more modification.
+ */
+class HashCache {
+public:
+    struct Stats {
+        std::size_t files_hit = 0;      ///< files with valid entry in the cache
+        std::size_t files_missed = 0;   ///< files without entry or with changed one
+        std::size_t blocks_cached = 0;  ///< block hashes taken from the cache
+        std::size_t blocks_read = 0;    ///< blocks read from disk and hashed
+    };
+
+    /// layout_id -- BlockLayout::id(), it's the block size for fixed size blocks
+    HashCache(std::string filename, std::uint64_t layout_id, HashType hash_type);
+
+    /// cached block hashes of the file, empty if there is no valid entry
+    std::vector<Hash> lookup(const FileStat& stat);
+    /// stores hashes of the file, blocks_read -- how many of them are computed in this run
+    void store(const FileStat& stat, const std::vector<Hash>& hashes, std::size_t blocks_read);
+    /// writes cache file if it was changed
+    void save();
+
+    [[nodiscard]] const Stats& stats() const {return stats_;}
+
+private:
+    struct Key {
+        std::uint64_t dev = 0;
+        std::uint64_t ino = 0;
+        std::uint64_t size = 0;
+        std::int64_t mtime_ns = 0;
+        std::uint64_t layout_id = 0;
+        std::uint32_t hash_type = 0;
+    };
+    friend bool operator==(const Key& lhs, const Key& rhs);
+    friend std::size_t hash_value(const Key& key);
+
+    std::string filename_;
+    std::uint64_t layout_id_ = 1;
+    HashType hash_type_ = HashType::Boost;
+    std::int64_t racy_after_ns_ = 0;
+    boost::unordered_map<Key, std::vector<Hash>> entries_;
+    Stats stats_;
+    bool changed_ = false;
+    std::mutex mtx_;
+
+    Key make_key(const FileStat& stat) const;
+    void load();
+};
+
+std::ostream& operator<<(std::ostream& out, const HashCache::Stats& stats);
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/// 128-bit hash value, 64-bit and 32-bit hashes fill only the low part
+struct Hash {
+    std::uint64_t low = 0;
+    std::uint64_t high = 0;
+
+    Hash() = default;
+    Hash(std::uint64_t low_part, std::uint64_t high_part = 0) : low(low_part), high(high_part) {}
+};
+
+inline bool operator==(const Hash& lhs, const Hash& rhs) {
+    return lhs.low == rhs.low && lhs.high == rhs.high;
+}
+
+inline bool operator!=(const Hash& lhs, const Hash& rhs) {
+    return !(lhs == rhs);
+}
+
+/// for boost::unordered_map
+inline std::size_t hash_value(const Hash& h) {
+    return static_cast<std::size_t>(h.low ^ (h.high * 0x9e3779b97f4a7c15ull));
+}
@@ -1,21 +1,79 @@
 #include "hasher.h"
 
+#include <cstring>
+
 #include <boost/crc.hpp>
 
+#include "blake3.h"
+#include "crc32c.h"
+#include "xxhash.h"
+
 using namespace std;
 
-Hash Crc32Hasher::operator()(const std::vector<char>& v) {
+Hash Crc32Hasher::operator()(ByteSpan bytes) {
     boost::crc_32_type result;
-    result.process_bytes(v.data(), v.size());
+    result.process_bytes(bytes.data(), bytes.size());
     return result.checksum();
 }
 
+Hash Crc32cHasher::operator()(ByteSpan bytes) {
+    return crc32c(bytes.data(), bytes.size());
+}
+
+Hash Xxh128Hasher::operator()(ByteSpan bytes) {
+    return xxh3_128(bytes.data(), bytes.size());
+}
+
+Hash Blake3Hasher::operator()(ByteSpan bytes) {
+    auto digest = blake3(bytes.data(), bytes.size());
+    Hash res;
+    std::memcpy(&res.low, digest.data(), sizeof(res.low));
+    std::memcpy(&res.high, digest.data() + sizeof(res.low), sizeof(res.high));
+    return res;
+}
+
+namespace {
+
+const std::pair<HashType, const char*> HASH_NAMES[] = {
+    {HashType::Boost, "boost"},
+    {HashType::CRC32, "crc32"},
+    {HashType::CRC32C, "crc32c"},
+    {HashType::XXH128, "xxh128"},
+    {HashType::BLAKE3, "blake3"},
+};
+
+} // namespace
+
+boost::optional<HashType> parseHashType(const std::string& name) {
+    for (const auto& [type, type_name] : HASH_NAMES) {
+        if (name == type_name) {
+            return type;
+        }
+    }
+    return boost::none;
+}
+
+const char* hashTypeName(HashType hash_type) {
+    for (const auto& [type, type_name] : HASH_NAMES) {
+        if (type == hash_type) {
+            return type_name;
+        }
+    }
+    return "unknown";
+}
+
 HasherHolder makeHasher(HashType hash_type) {
     switch (hash_type) {
         case HashType::Boost:
             return make_unique<BoostHasher>();
         case HashType::CRC32:
             return make_unique<Crc32Hasher>();
+        case HashType::CRC32C:
+            return make_unique<Crc32cHasher>();
+        case HashType::XXH128:
+            return make_unique<Xxh128Hasher>();
+        case HashType::BLAKE3:
+            return make_unique<Blake3Hasher>();
         default:
             throw runtime_error("Unknown hash type");
     }
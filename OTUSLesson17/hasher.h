@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <memory>
+#include <string>
 
 #include <boost/version.hpp>
 #if  BOOST_VERSION >= 106700
@@ -9,29 +10,65 @@
 #else
 #include <boost/functional/hash.hpp>
 #endif
+#include <boost/optional.hpp>
 
-using Hash = std::size_t;
-enum class HashType {Boost, CRC32};
+#include "hash_value.h"
+
+enum class HashType {Boost, CRC32, CRC32C, XXH128, BLAKE3};
+
+/// non-owning view of bytes (std::span<const char> analog)
+class ByteSpan {
+public:
+    ByteSpan(const char* data, std::size_t size) : data_(data), size_(size) {}
+    ByteSpan(const std::vector<char>& v) : data_(v.data()), size_(v.size()) {}
+    [[nodiscard]] const char* data() const {return data_;}
+    [[nodiscard]] std::size_t size() const {return size_;}
+    [[nodiscard]] const char* begin() const {return data_;}
+    [[nodiscard]] const char* end() const {return data_ + size_;}
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+};
 
 class IHasher {
 public:
     virtual ~IHasher() = default;
-    virtual Hash operator()(const std::vector<char>&) = 0;
+    virtual Hash operator()(ByteSpan bytes) = 0;
 };
 using HasherHolder = std::unique_ptr<IHasher>;
 
 class BoostHasher : public  IHasher {
 public:
-    Hash operator()(const std::vector<char>& v) override {return hasher_(v);}
-private:
-    boost::hash<std::vector<char>> hasher_;
+    Hash operator()(ByteSpan bytes) override {return boost::hash_range(bytes.begin(), bytes.end());}
 };
 
 class Crc32Hasher : public IHasher {
 public:
-    Hash operator()(const std::vector<char>& v) override;
+    Hash operator()(ByteSpan bytes) override;
+};
+
+/// CRC32C, hardware accelerated with SSE4.2
+class Crc32cHasher : public IHasher {
+public:
+    Hash operator()(ByteSpan bytes) override;
+};
+
+/// xxHash XXH3 128-bit
+class Xxh128Hasher : public IHasher {
+public:
+    Hash operator()(ByteSpan bytes) override;
+};
+
+/// BLAKE3 truncated to 128 bits, for collision resistance
+class Blake3Hasher : public IHasher {
+public:
+    Hash operator()(ByteSpan bytes) override;
 };
 
 HasherHolder makeHasher(HashType hash_type);
 
+/// parses hash name as in --hash option, boost::none if name is unknown
+boost::optional<HashType> parseHashType(const std::string& name);
+const char* hashTypeName(HashType hash_type);
+
 
@@ -15,12 +15,29 @@ int main(int argc, char* argv[]) {
         if (!optional_options) {
             return 0;
         }
-        auto [files, block_size, hashType] = *optional_options;
+        const auto& options = *optional_options;
 
-        auto hasher = makeHasher(hashType);
-        CompareFiles fileComparator(block_size, *hasher);
+        auto hasher = makeHasher(options.hash_type);
+        CompareFiles fileComparator(options.layout, *hasher, options.threads_num,
+                options.read_mode);
+        fileComparator.setFirstLastMode(options.first_last);
 
-        cout << fileComparator.compare(files);
+        boost::optional<HashCache> cache;
+        if (!options.cache_file.empty()) {
+            cache.emplace(options.cache_file, options.layout.id(), options.hash_type);
+            fileComparator.useHashCache(*cache);
+        }
+
+        if (options.dir.empty()) {
+            cout << fileComparator.compare(options.files);
+        } else {
+            DirWalker walker(options.dir, options.threads_num);
+            cout << fileComparator.compare(walker);
+        }
+        if (cache) {
+            cache->save();
+            cerr << cache->stats() << endl;
+        }
     }
     catch (const opt::error& e) {
         cerr << e.what() << endl;
@@ -5,22 +5,30 @@
 #include <boost/program_options.hpp>
 
 
+#include <boost/filesystem.hpp>
+
 #include "file_utils.h"
 
 using namespace std;
 namespace opt = boost::program_options;
+namespace fs = boost::filesystem;
 
 //#define TEST
 
-boost::optional<std::tuple<std::vector<std::string>, int, HashType>>
-    parse_command_oprions(int argc, char* argv[])
+boost::optional<BayanOptions> parse_command_oprions(int argc, char* argv[])
 {
     // parse command line
     opt::options_description desc("Usage: bayan [OPTIONS]... [FILE]...\nAll options:");
     desc.add_options()
             ("help,h", "This screen")
-            ("blocksize,b", opt::value<int>()->default_value(1), "Block size")
-            ("hash,H", opt::value<std::string>(), "Hash type: boost, crc32")
+            ("blocksize,b", opt::value<int>(), "Fixed block size (default is adaptive block size)")
+            ("adaptive,a", opt::value<std::string>(),
+                    "Adaptive block size MIN:MAX, blocks grow from MIN to MAX bytes (default 4096:1048576)")
+            ("hash,H", opt::value<std::string>(), "Hash type: boost, crc32, crc32c, xxh128, blake3")
+            ("threads,j", opt::value<int>()->default_value(1), "Threads number for reading and hashing blocks")
+            ("mmap,m", "Read files via mmap (default is pread)")
+            ("first-last,l", "Compare the first and the last blocks before the others")
+            ("cache,c", opt::value<std::string>(), "File of persistent block hash cache for repeated runs")
             ("dir,d", opt::value<std::string>(), "Directory, where to search duplicates (recursive search)")
             ("files,f", opt::value<std::vector<std::string>>()->multitoken()->
                     zero_tokens()->composing(), "files to scan, can be used without -f ");
@@ -35,43 +43,62 @@ boost::optional<std::tuple<std::vector<std::string>, int, HashType>>
     opt::store(parsed_options, vm);
     opt::notify(vm);
 
-    vector<string> files;
-    int block_size = 1;
-    HashType hashType = HashType::Boost;
+    BayanOptions options;
+    auto& files = options.files;
     if (vm.count("help")) {
         cout << desc << endl;
         return boost::none;
     }
     if (vm.count("blocksize")) {
-        block_size = vm["blocksize"].as<int>();
+        int block_size = vm["blocksize"].as<int>();
+        if (block_size < 1) {
+            throw invalid_argument("Block size must be positive");
+        }
+        options.layout = BlockLayout::fixed(static_cast<size_t>(block_size));
+    } else if (vm.count("adaptive")) {
+        auto sizes = vm["adaptive"].as<std::string>();
+        auto colon = sizes.find(':');
+        if (colon == std::string::npos) {
+            throw invalid_argument("Adaptive block size must be MIN:MAX");
+        }
+        options.layout = BlockLayout::adaptive(std::stoul(sizes.substr(0, colon)),
+                std::stoul(sizes.substr(colon + 1)));
+    }
+    if (vm.count("threads")) {
+        int threads_num = vm["threads"].as<int>();
+        if (threads_num < 1) {
+            throw invalid_argument("Threads number must be positive");
+        }
+        options.threads_num = static_cast<size_t>(threads_num);
+    }
+    if (vm.count("mmap")) {
+        options.read_mode = ReadMode::Mmap;
+    }
+    if (vm.count("first-last")) {
+        options.first_last = true;
+    }
+    if (vm.count("cache")) {
+        options.cache_file = vm["cache"].as<std::string>();
     }
     if (vm.count("dir")) {
-        files = getFileListRecursive(vm["dir"].as<std::string>());
-#ifdef TEST
-        cerr << "Found " << files.size() << " files" << endl;
-            for (const auto& filename : files) {
-                cerr << filename << " = " << get_file_size(filename) << endl;
-            }
-#endif
+        options.dir = vm["dir"].as<std::string>();
     } else if (vm.count("files")) {
         files = vm["files"].as<std::vector<std::string>>();
         make_full_paths(files);
         remove_non_valid_paths(files);
         sort_names_and_remove_duplic(files);
     } else {
-        files = getFileListRecursive("");
+        options.dir = fs::current_path().string();
     }
     if (vm.count("hash")) {
         string h = vm["hash"].as<std::string>();
-        if (h == "crc32") {
-            hashType = HashType::CRC32;
-        } else if (h == "boost") {
-            //hashType is already HashType::Boost;
+        if (auto hash_type = parseHashType(h)) {
+            options.hash_type = *hash_type;
         } else {
             cerr << "unknown hash type: " << h
                  << ". Default hash is set. For more info use --help" << endl;
         }
     }
-    return make_tuple(files, block_size, hashType);
+    return options;
 }
 
@@ -6,7 +6,20 @@
 
 #include <boost/optional.hpp>
 
+#include "block_layout.h"
+#include "block_source.h"
 #include "hasher.h"
 
-boost::optional<std::tuple<std::vector<std::string>, int, HashType>>
-        parse_command_oprions(int argc, char* argv[]);
\ No newline at end of file
+struct BayanOptions {
+    std::vector<std::string> files;
+    std::string dir;          ///< directory to walk, it's used if files list is empty
+    /// adaptive 4 KiB -> 1 MiB blocks if block size isn't set
+    BlockLayout layout = BlockLayout::adaptive(4096, 1 << 20);
+    HashType hash_type = HashType::Boost;
+    std::size_t threads_num = 1;
+    ReadMode read_mode = ReadMode::Pread;
+    bool first_last = false;  ///< compare the first and the last blocks first
+    std::string cache_file;   ///< persistent block hash cache, empty -- no cache
+};
+
+boost::optional<BayanOptions> parse_command_oprions(int argc, char* argv[]);
@@ -5,10 +5,65 @@
 #include <vector>
 #include <iostream>
 #include <cstdint>
+#include <fstream>
+#include <algorithm>
+#include <ctime>
 
+#include <boost/filesystem.hpp>
+
+#include "blake3.h"
+#include "crc32c.h"
+#include "dir_walker.h"
 #include "hasher.h"
 #include "file_cmp.h"
 
+namespace fs = boost::filesystem;
+
+/// creates files with the given contents in a temporary directory, removes it at the end
+class TempFiles {
+public:
+    explicit TempFiles(const vector<string>& contents)
+        : dir_(fs::temp_directory_path() / fs::unique_path("bayan_test_%%%%-%%%%"))
+    {
+        fs::create_directories(dir_);
+        for (size_t i = 0; i < contents.size(); ++i) {
+            auto fname = (dir_ / ("file" + to_string(i))).string();
+            ofstream out(fname, ios::binary);
+            out << contents[i];
+            files_.push_back(fname);
+        }
+    }
+    ~TempFiles() {
+        fs::remove_all(dir_);
+    }
+    const vector<string>& files() const {return files_;}
+    const string& operator[](size_t idx) const {return files_.at(idx);}
+private:
+    fs::path dir_;
+    vector<string> files_;
+};
+
+bool has_group(const CompareFiles::DuplicateList& res, const vector<string>& group) {
+    return any_of(res.begin(), res.end(), [&group](const auto& dup_group) {
+        return dup_group.size() == group.size()
+            && all_of(group.begin(), group.end(), [&dup_group](const auto& f) {
+                return dup_group.count(f) != 0;
+            });
+    });
+}
+
+/// counts hashed blocks
+class CountingHasher : public IHasher {
+public:
+    Hash operator()(ByteSpan bytes) override {
+        ++count;
+        return hasher_(bytes);
+    }
+    std::size_t count = 0;
+private:
+    BoostHasher hasher_;
+};
+
 using namespace std;
 
 BOOST_AUTO_TEST_SUITE(bayan_test_suite)
@@ -46,6 +101,51 @@ BOOST_AUTO_TEST_SUITE(bayan_test_suite)
         }
     }
 
+    BOOST_AUTO_TEST_CASE(test_fast_hashers) {
+        const string check = "123456789";
+        BOOST_CHECK(crc32c(check.data(), check.size()) == 0xE3069283u);
+        vector<char> data(4096);
+        for (size_t i = 0; i < data.size(); ++i) {
+            data[i] = static_cast<char>(i % 251);
+        }
+        for (size_t len : {0u, 1u, 7u, 8u, 9u, 100u, 4096u}) {
+            BOOST_CHECK(crc32c(data.data(), len) == crc32c_sw(data.data(), len));
+        }
+
+        auto xxh = makeHasher(HashType::XXH128);
+        BOOST_CHECK((*xxh)(ByteSpan("", 0)) == Hash(0x6001c324468d497full, 0x99aa06d3014798d8ull));
+        BOOST_CHECK((*xxh)(ByteSpan("abc", 3)) == Hash(0x78af5f94892f3950ull, 0x06b05ab6733a6185ull));
+        BOOST_CHECK((*xxh)(data) == Hash(0x7135ffa504f1bc71ull, 0xe12cd72144990fe5ull));
+
+        // official BLAKE3 test vectors, input is i % 251
+        auto to_hex = [](const auto& digest) {
+            string res;
+            for (auto byte : digest) {
+                const char* digits = "0123456789abcdef";
+                res += digits[byte >> 4];
+                res += digits[byte & 0xf];
+            }
+            return res;
+        };
+        BOOST_CHECK(to_hex(blake3(data.data(), 0))
+                == "af1349b9f5f9a1a6a0404dea36dcc9499bcb25c9adc112b7cc9a93cae41f3262");
+        BOOST_CHECK(to_hex(blake3(data.data(), 1025))
+                == "d00278ae47eb27b34faecf67b4fe263f82d5412916c1ffd97c8cb7fb814b8444");
+        BOOST_CHECK(to_hex(blake3(data.data(), 4096))
+                == "015094013f57a5277b59d8475c0501042c0b642e531b0a1c8f58d2163229e969");
+
+        for (auto hash_type : {HashType::CRC32C, HashType::XXH128, HashType::BLAKE3}) {
+            BOOST_CHECK(parseHashType(hashTypeName(hash_type)) == hash_type);
+            auto hasher = makeHasher(hash_type);
+            TempFiles tmp({"aaaabbbbcccc", "aaaabbbbcccd", "aaaabbbbcccc"});
+            CompareFiles fileComparator(4, *hasher);
+            auto res = fileComparator.compare(tmp.files());
+            BOOST_CHECK(res.size() == 1u);
+            BOOST_CHECK(has_group(res, {tmp[0], tmp[2]}));
+        }
+        BOOST_CHECK(!parseHashType("md5"));
+    }
+
     BOOST_AUTO_TEST_CASE(test_bayan) {
         auto hasher = makeHasher(HashType::Boost);
         {
@@ -103,5 +203,306 @@ BOOST_AUTO_TEST_SUITE(bayan_test_suite)
         }
     }
 
+    BOOST_AUTO_TEST_CASE(test_staged_groups) {
+        auto hasher = makeHasher(HashType::Boost);
+        TempFiles tmp({"aaaabbbbcccc", "aaaabbbbcccd", "aaaabbbbcccc", "xaaabbbbcccc",
+                       "aaaabbbbcccd", "aaaaxbbbcccc", "aaaabbbbcccc", "short", "short"});
+        CompareFiles fileComparator(4, *hasher);
+        auto res = fileComparator.compare(tmp.files());
+        BOOST_CHECK(res.size() == 3u);
+        BOOST_CHECK(has_group(res, {tmp[0], tmp[2], tmp[6]}));
+        BOOST_CHECK(has_group(res, {tmp[1], tmp[4]}));
+        BOOST_CHECK(has_group(res, {tmp[7], tmp[8]}));
+    }
+
+    BOOST_AUTO_TEST_CASE(test_parallel_same_result) {
+        auto hasher = makeHasher(HashType::CRC32);
+        vector<string> contents;
+        for (int i = 0; i < 100; ++i) {
+            contents.push_back(string(10 + i % 7, 'a') + char('a' + i % 3));
+        }
+        TempFiles tmp(contents);
+        CompareFiles seqComparator(4, *hasher);
+        auto expected = seqComparator.compare(tmp.files());
+        BOOST_CHECK(expected.size() == 21u);
+        for (size_t threads : {2u, 4u}) {
+            CompareFiles parComparator(4, *hasher, threads);
+            BOOST_CHECK(parComparator.compare(tmp.files()) == expected);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(test_mmap_same_result) {
+        auto hasher = makeHasher(HashType::Boost);
+        // last block is padded with zeros, so "abcde" and "abcde\0" are equal for block size 3
+        TempFiles tmp({"abcdefgh", "abcdefgh", "abcde", string("abcde\0", 6), "abcdefgx"});
+        CompareFiles preadComparator(3, *hasher, 1, ReadMode::Pread);
+        auto expected = preadComparator.compare(tmp.files());
+        BOOST_CHECK(expected.size() == 1u);
+        BOOST_CHECK(has_group(expected, {tmp[0], tmp[1]}));
+        for (size_t threads : {1u, 2u}) {
+            CompareFiles mmapComparator(3, *hasher, threads, ReadMode::Mmap);
+            BOOST_CHECK(mmapComparator.compare(tmp.files()) == expected);
+        }
+
+        FileHasher preadHasher(tmp[3], 3, *hasher, ReadMode::Pread);
+        FileHasher mmapHasher(tmp[2], 3, *hasher, ReadMode::Mmap);
+        BOOST_CHECK(preadHasher[1] == mmapHasher[1]);
+        BOOST_CHECK(preadHasher[0] == mmapHasher[0]);
+        BOOST_CHECK(!preadHasher[2] && !mmapHasher[2]);
+    }
+
+    BOOST_AUTO_TEST_CASE(test_mmap_truncated_file) {
+        auto hasher = makeHasher(HashType::Boost);
+        // blocks span several pages, access to a page past the end of the file raises SIGBUS
+        constexpr size_t BLOCK_SIZE = 8192;
+        TempFiles tmp({string(4 * BLOCK_SIZE, 'a')});
+        FileHasher mmapHasher(tmp[0], BLOCK_SIZE, *hasher, ReadMode::Mmap);
+        BOOST_CHECK(mmapHasher[0]);
+        // another process truncates the file during the scan
+        fs::resize_file(tmp[0], BLOCK_SIZE);
+        BOOST_CHECK(!mmapHasher[2]);
+        BOOST_CHECK(!mmapHasher[3]);
+    }
+
+    BOOST_AUTO_TEST_CASE(test_hash_cache) {
+        auto hasher = makeHasher(HashType::XXH128);
+        TempFiles tmp({"aaaabbbbcccc", "aaaabbbbcccd", "aaaabbbbcccc", "xyz"});
+        // recently modified files aren't cached
+        for (const auto& f : tmp.files()) {
+            fs::last_write_time(f, time(nullptr) - 100);
+        }
+        auto cache_file = tmp[0] + ".cache";
+        CompareFiles::DuplicateList expected;
+        {
+            HashCache cache(cache_file, 4, HashType::XXH128);
+            CompareFiles fileComparator(4, *hasher);
+            fileComparator.useHashCache(cache);
+            expected = fileComparator.compare(tmp.files());
+            cache.save();
+            BOOST_CHECK(cache.stats().files_hit == 0u);
+            BOOST_CHECK(cache.stats().files_missed == 3u);
+            BOOST_CHECK(cache.stats().blocks_read == 9u);
+        }
+        BOOST_CHECK(expected.size() == 1u);
+        BOOST_CHECK(has_group(expected, {tmp[0], tmp[2]}));
+        {
+            // corrupted tail record with a huge hashes count is dropped
+            ofstream out(cache_file, ios::binary | ios::app);
+            const string header(44, '\0');
+            const std::uint32_t hashes_count = 0xffffffff;
+            out.write(header.data(), static_cast<std::streamsize>(header.size()));
+            out.write(reinterpret_cast<const char*>(&hashes_count), sizeof(hashes_count));
+        }
+        {
+            // unchanged files aren't read at all
+            HashCache cache(cache_file, 4, HashType::XXH128);
+            CompareFiles fileComparator(4, *hasher);
+            fileComparator.useHashCache(cache);
+            BOOST_CHECK(fileComparator.compare(tmp.files()) == expected);
+            BOOST_CHECK(cache.stats().files_hit == 3u);
+            BOOST_CHECK(cache.stats().files_missed == 0u);
+            BOOST_CHECK(cache.stats().blocks_read == 0u);
+            BOOST_CHECK(cache.stats().blocks_cached == 9u);
+        }
+        {
+            // other block size or hash type -- other entries
+            HashCache cache(cache_file, 2, HashType::XXH128);
+            BOOST_CHECK(cache.lookup(*get_file_stat(tmp[0])).empty());
+            HashCache cache_crc(cache_file, 4, HashType::CRC32C);
+            BOOST_CHECK(cache_crc.lookup(*get_file_stat(tmp[0])).empty());
+        }
+        {
+            // changed file is read again
+            ofstream(tmp[2], ios::binary) << "aaaabbbbcccd";
+            fs::last_write_time(tmp[2], time(nullptr) - 50);
+            HashCache cache(cache_file, 4, HashType::XXH128);
+            CompareFiles fileComparator(4, *hasher);
+            fileComparator.useHashCache(cache);
+            auto res = fileComparator.compare(tmp.files());
+            BOOST_CHECK(res.size() == 1u);
+            BOOST_CHECK(has_group(res, {tmp[1], tmp[2]}));
+            BOOST_CHECK(cache.stats().files_hit == 2u);
+            BOOST_CHECK(cache.stats().blocks_read == 3u);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(test_dir_walker) {
+        TempFiles tmp({"aaaabbbbcccc", "aaaabbbbcccd", "aaaabbbbcccc", "", "xyz"});
+        auto root = fs::path(tmp[0]).parent_path();
+        // nested directories with more copies and a symlink which must be skipped
+        fs::create_directories(root / "d1" / "d2");
+        fs::create_directories(root / "d3");
+        fs::copy_file(tmp[0], root / "d1" / "copy0");
+        fs::copy_file(tmp[1], root / "d1" / "d2" / "copy1");
+        fs::copy_file(tmp[4], root / "d3" / "copy4");
+        fs::create_symlink(tmp[0], root / "d3" / "link0");
+
+        auto expected_files = tmp.files();
+        for (const auto* f : {"d1/copy0", "d1/d2/copy1", "d3/copy4"}) {
+            expected_files.push_back((root / f).string());
+        }
+        sort(expected_files.begin(), expected_files.end());
+        for (size_t threads : {1u, 3u}) {
+            auto files = getFileListRecursive(root.string(), threads);
+            sort(files.begin(), files.end());
+            BOOST_CHECK(files == expected_files);
+
+            DirWalker walker(root.string(), threads);
+            auto hasher = makeHasher(HashType::CRC32C);
+            CompareFiles fileComparator(4, *hasher);
+            auto res = fileComparator.compare(walker);
+            BOOST_CHECK(res.size() == 3u);
+            BOOST_CHECK(has_group(res, {tmp[0], tmp[2], (root / "d1" / "copy0").string()}));
+            BOOST_CHECK(has_group(res, {tmp[1], (root / "d1" / "d2" / "copy1").string()}));
+            BOOST_CHECK(has_group(res, {tmp[4], (root / "d3" / "copy4").string()}));
+        }
+        {
+            // walker can be destroyed before the walk is finished
+            DirWalker walker(root.string(), 2);
+            BOOST_CHECK(walker.next());
+        }
+        BOOST_CHECK(getFileListRecursive((root / "no_such_dir").string()).empty());
+    }
+
+    BOOST_AUTO_TEST_CASE(test_hardlinks) {
+        TempFiles tmp({"unique size", "aaaabbbbcccc", "aaaabbbbcccc", "aaaabbbbxxxx"});
+        auto root = fs::path(tmp[0]).parent_path();
+        auto link0 = (root / "link0").string();
+        auto link1 = (root / "link1").string();
+        auto link3 = (root / "link3").string();
+        fs::create_hard_link(tmp[0], link0);
+        fs::create_hard_link(tmp[1], link1);
+        fs::create_hard_link(tmp[3], link3);
+
+        CountingHasher hasher;
+        CompareFiles fileComparator(4, hasher);
+        auto files = tmp.files();
+        files.insert(files.end(), {link0, link1, link3});
+        auto res = fileComparator.compare(files);
+        BOOST_CHECK(res.size() == 3u);
+        BOOST_CHECK(has_group(res, {tmp[0], link0}));
+        BOOST_CHECK(has_group(res, {tmp[1], link1, tmp[2]}));
+        BOOST_CHECK(has_group(res, {tmp[3], link3}));
+        // 3 inodes of 3 blocks are read once, file of unique size isn't read at all
+        BOOST_CHECK(hasher.count == 9u);
+    }
+
+    BOOST_AUTO_TEST_CASE(test_not_regular_files) {
+        TempFiles tmp({"aaaabbbbcccc", "xyz"});
+        auto root = fs::path(tmp[0]).parent_path();
+        auto symlink = (root / "symlink0").string();
+        auto dir = (root / "dir").string();
+        fs::create_symlink(tmp[0], symlink);
+        fs::create_directories(dir);
+
+        // symlink isn't a duplicate of its target, directory isn't a file
+        auto hasher = makeHasher(HashType::CRC32C);
+        CompareFiles fileComparator(4, *hasher);
+        BOOST_CHECK(fileComparator.compare({tmp[0], symlink, tmp[1], dir}).empty());
+        BOOST_CHECK(!get_file_stat(symlink));
+        BOOST_CHECK(!get_file_stat(dir));
+    }
+
+    BOOST_AUTO_TEST_CASE(test_first_last_mode) {
+        string prefix(100, 'a');
+        TempFiles tmp({prefix + "1", prefix + "2", prefix + "1", "b" + prefix});
+        for (bool first_last : {false, true}) {
+            CountingHasher hasher;
+            CompareFiles fileComparator(10, hasher);
+            fileComparator.setFirstLastMode(first_last);
+            auto res = fileComparator.compare(tmp.files());
+            BOOST_CHECK(res.size() == 1u);
+            BOOST_CHECK(has_group(res, {tmp[0], tmp[2]}));
+            // 11 blocks per file: files 0-2 are read fully in both modes,
+            // but file 1 is rejected after 2 blocks in first-last mode
+            BOOST_CHECK(hasher.count == (first_last ? 1u + 11 + 2 + 11 : 1u + 11 + 11 + 11));
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(test_tiny_files) {
+        TempFiles tmp({"abc", "abd", "abc", "abc", string("ab\0", 3), "abcdefgh"});
+        CountingHasher hasher;
+        CompareFiles fileComparator(4096, hasher, 2);
+        // tiny groups don't use block hashes, so they don't look into the cache
+        HashCache cache(tmp[0] + ".cache", 4096, HashType::XXH128);
+        fileComparator.useHashCache(cache);
+        auto res = fileComparator.compare(tmp.files());
+        BOOST_CHECK(res.size() == 1u);
+        BOOST_CHECK(has_group(res, {tmp[0], tmp[2], tmp[3]}));
+        BOOST_CHECK(hasher.count == 0u);
+        BOOST_CHECK(cache.stats().files_hit == 0u);
+        BOOST_CHECK(cache.stats().files_missed == 0u);
+    }
+
+    BOOST_AUTO_TEST_CASE(test_block_layout) {
+        auto fixed = BlockLayout::fixed(4);
+        BOOST_CHECK(fixed.blocksCount(0) == 0u);
+        BOOST_CHECK(fixed.blocksCount(9) == 3u);
+        BOOST_CHECK(fixed.blockOffset(2) == 8u);
+        BOOST_CHECK(fixed.id() == 4u);
+
+        // 2, 4, 8, 10, 10, ...
+        auto adaptive = BlockLayout::adaptive(2, 10);
+        BOOST_CHECK(adaptive.blockSize(0) == 2u);
+        BOOST_CHECK(adaptive.blockSize(2) == 8u);
+        BOOST_CHECK(adaptive.blockSize(3) == 10u);
+        BOOST_CHECK(adaptive.blockSize(10) == 10u);
+        BOOST_CHECK(adaptive.blockOffset(3) == 14u);
+        BOOST_CHECK(adaptive.blockOffset(5) == 34u);
+        BOOST_CHECK(adaptive.blocksCount(1) == 1u);
+        BOOST_CHECK(adaptive.blocksCount(6) == 2u);
+        BOOST_CHECK(adaptive.blocksCount(7) == 3u);
+        BOOST_CHECK(adaptive.blocksCount(14) == 3u);
+        BOOST_CHECK(adaptive.blocksCount(15) == 4u);
+        BOOST_CHECK(adaptive.blocksCount(34) == 5u);
+        // the last block of adaptive layout isn't padded
+        BOOST_CHECK(adaptive.readSize(3, 20) == 6u);
+        BOOST_CHECK(adaptive.readSize(3, 100) == 10u);
+        BOOST_CHECK(fixed.readSize(2, 9) == 4u);
+        for (std::uint64_t size = 1; size < 100; ++size) {
+            auto count = adaptive.blocksCount(size);
+            BOOST_CHECK(adaptive.blockOffset(count - 1) < size);
+            BOOST_CHECK(adaptive.blockOffset(count) >= size);
+        }
+        BOOST_CHECK(adaptive.id() != BlockLayout::adaptive(2, 20).id());
+        BOOST_CHECK(adaptive.id() != fixed.id());
+        BOOST_CHECK_THROW(BlockLayout::adaptive(8, 4), invalid_argument);
+    }
+
+    BOOST_AUTO_TEST_CASE(test_adaptive_blocks) {
+        string prefix(1000, 'a');
+        TempFiles tmp({prefix + "1", prefix + "2", prefix + "1", "b" + prefix, prefix + "1"});
+        for (auto read_mode : {ReadMode::Pread, ReadMode::Mmap}) {
+            CountingHasher hasher;
+            CompareFiles fileComparator(BlockLayout::adaptive(4, 256), hasher, 1, read_mode);
+            auto res = fileComparator.compare(tmp.files());
+            BOOST_CHECK(res.size() == 1u);
+            BOOST_CHECK(has_group(res, {tmp[0], tmp[2], tmp[4]}));
+            // 4, 8, 16, 32, 64, 128, 256, 256, 256 -- file 3 is rejected after the first block
+            BOOST_CHECK(hasher.count == 1u + 4 * 9);
+        }
+
+        // hash cache entries of different layouts don't mix
+        for (const auto& f : tmp.files()) {
+            fs::last_write_time(f, time(nullptr) - 100);
+        }
+        auto cache_file = tmp[0] + ".cache";
+        auto hasher = makeHasher(HashType::XXH128);
+        for (const auto& layout : {BlockLayout::adaptive(4, 256), BlockLayout::fixed(4),
+                                   BlockLayout::adaptive(4, 256), BlockLayout::fixed(4)})
+        {
+            HashCache cache(cache_file, layout.id(), HashType::XXH128);
+            CompareFiles fileComparator(layout, *hasher);
+            fileComparator.useHashCache(cache);
+            auto res = fileComparator.compare(tmp.files());
+            cache.save();
+            BOOST_CHECK(res.size() == 1u);
+            BOOST_CHECK(has_group(res, {tmp[0], tmp[2], tmp[4]}));
+        }
+        HashCache cache(cache_file, BlockLayout::adaptive(4, 256).id(), HashType::XXH128);
+        BOOST_CHECK(cache.lookup(*get_file_stat(tmp[0])).size() == 9u);
+        HashCache fixed_cache(cache_file, 4, HashType::XXH128);
+        BOOST_CHECK(fixed_cache.lookup(*get_file_stat(tmp[0])).size() == 251u);
+    }
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -28,7 +28,11 @@ ThreadPool::ThreadPool(std::size_t threads_num)
 }
 
 ThreadPool::~ThreadPool() {
-    quit_ = true;
+    {
+        // under the lock: a worker between its predicate check and wait can't miss the wakeup
+        std::lock_guard<std::mutex> l(cv_m_);
+        quit_ = true;
+    }
     condition_.notify_all();
     for (auto& worker : workers_) {
         worker.join();
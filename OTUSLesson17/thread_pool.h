@@ -3,11 +3,12 @@
 #include <future>
 #include <thread>
 #include <condition_variable>
-#include <atomic>
 #include <queue>
 #include <vector>
 #include <tuple>
 #include <functional>
+#include <memory>
+#include <stdexcept>
 #include <utility>
 
 class ThreadPool {
@@ -23,15 +24,26 @@ public:
             if (quit_) {
                 throw std::runtime_error("adding task to stopped threadpool");
             }
-            tasks_.emplace(std::async(std::launch::deferred, std::forward<F>(f), std::forward<Args>(args)...));
+            tasks_.emplace(std::async(std::launch::deferred, std::forward<F>(f),
+                    std::forward<Args>(args)...));
         }
         condition_.notify_one();
     }
 
+    /// adds task and returns future for its result (exception is passed to the future too)
+    template <typename F>
+    auto submit(F f) -> std::future<decltype(f())> {
+        using Result = decltype(f());
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::move(f));
+        auto res = task->get_future();
+        addTask([task](){ (*task)(); });
+        return res;
+    }
+
 private:
     std::mutex cv_m_;
     std::condition_variable condition_;
-    std::atomic_bool quit_ = false;
+    bool quit_ = false;             ///< guarded by cv_m_
     std::queue<Task> tasks_;
     std::vector<std::thread> workers_;
-};
\ No newline at end of file
+};
@@ -0,0 +1,247 @@
+#include "xxhash.h"
+
+#include <cstring>
+
+namespace {
+
+constexpr std::uint32_t PRIME32_1 = 0x9E3779B1u;
+constexpr std::uint32_t PRIME32_2 = 0x85EBCA77u;
+constexpr std::uint32_t PRIME32_3 = 0xC2B2AE3Du;
+constexpr std::uint64_t PRIME64_1 = 0x9E3779B185EBCA87ull;
+constexpr std::uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4Full;
+constexpr std::uint64_t PRIME64_3 = 0x165667B19E3779F9ull;
+constexpr std::uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ull;
+constexpr std::uint64_t PRIME64_5 = 0x27D4EB2F165667C5ull;
+constexpr std::uint64_t PRIME_MX1 = 0x165667919E3779F9ull;
+constexpr std::uint64_t PRIME_MX2 = 0x9FB21C651E98DF25ull;
+
+constexpr std::size_t SECRET_SIZE = 192;
+constexpr std::size_t STRIPE_LEN = 64;
+constexpr std::size_t SECRET_CONSUME_RATE = 8;
+constexpr std::size_t ACC_NB = STRIPE_LEN / sizeof(std::uint64_t);
+constexpr std::size_t MIDSIZE_MAX = 240;
+constexpr std::size_t MIDSIZE_STARTOFFSET = 3;
+constexpr std::size_t MIDSIZE_LASTOFFSET = 17;
+constexpr std::size_t SECRET_SIZE_MIN = 136;
+constexpr std::size_t SECRET_LASTACC_START = 7;
+constexpr std::size_t SECRET_MERGEACCS_START = 11;
+
+alignas(64) constexpr unsigned char SECRET[SECRET_SIZE] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+template <typename P>
+std::uint64_t read64(const P* p) {
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+template <typename P>
+std::uint32_t read32(const P* p) {
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+std::uint32_t rotl32(std::uint32_t x, unsigned r) {
+    return (x << r) | (x >> (32 - r));
+}
+
+Hash mult64to128(std::uint64_t lhs, std::uint64_t rhs) {
+    auto product = static_cast<unsigned __int128>(lhs) * rhs;
+    return {static_cast<std::uint64_t>(product), static_cast<std::uint64_t>(product >> 64)};
+}
+
+std::uint64_t mul128_fold64(std::uint64_t lhs, std::uint64_t rhs) {
+    auto product = mult64to128(lhs, rhs);
+    return product.low ^ product.high;
+}
+
+std::uint64_t xxh64_avalanche(std::uint64_t h) {
+    h ^= h >> 33;
+    h *= PRIME64_2;
+    h ^= h >> 29;
+    h *= PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+std::uint64_t xxh3_avalanche(std::uint64_t h) {
+    h ^= h >> 37;
+    h *= PRIME_MX1;
+    h ^= h >> 32;
+    return h;
+}
+
+std::uint64_t mix16b(const char* input, const unsigned char* secret) {
+    return mul128_fold64(read64(input) ^ read64(secret), read64(input + 8) ^ read64(secret + 8));
+}
+
+Hash mix32b(Hash acc, const char* input_1, const char* input_2, const unsigned char* secret) {
+    acc.low += mix16b(input_1, secret);
+    acc.low ^= read64(input_2) + read64(input_2 + 8);
+    acc.high += mix16b(input_2, secret + 16);
+    acc.high ^= read64(input_1) + read64(input_1 + 8);
+    return acc;
+}
+
+Hash finalize_mid(Hash acc, std::size_t size) {
+    Hash res{acc.low + acc.high,
+             acc.low * PRIME64_1 + acc.high * PRIME64_4 + size * PRIME64_2};
+    res.low = xxh3_avalanche(res.low);
+    res.high = 0 - xxh3_avalanche(res.high);
+    return res;
+}
+
+Hash len_1to3(const char* input, std::size_t size) {
+    auto c1 = static_cast<std::uint32_t>(static_cast<unsigned char>(input[0]));
+    auto c2 = static_cast<std::uint32_t>(static_cast<unsigned char>(input[size >> 1]));
+    auto c3 = static_cast<std::uint32_t>(static_cast<unsigned char>(input[size - 1]));
+    std::uint32_t combined_l = (c1 << 16) | (c2 << 24) | c3 | static_cast<std::uint32_t>(size << 8);
+    std::uint32_t combined_h = rotl32(__builtin_bswap32(combined_l), 13);
+    std::uint64_t bitflip_l = read32(SECRET) ^ read32(SECRET + 4);
+    std::uint64_t bitflip_h = read32(SECRET + 8) ^ read32(SECRET + 12);
+    return {xxh64_avalanche(combined_l ^ bitflip_l), xxh64_avalanche(combined_h ^ bitflip_h)};
+}
+
+Hash len_4to8(const char* input, std::size_t size) {
+    std::uint64_t input_64 = read32(input) + (static_cast<std::uint64_t>(read32(input + size - 4)) << 32);
+    std::uint64_t bitflip = read64(SECRET + 16) ^ read64(SECRET + 24);
+    auto m = mult64to128(input_64 ^ bitflip, PRIME64_1 + (size << 2));
+    m.high += m.low << 1;
+    m.low ^= m.high >> 3;
+    m.low ^= m.low >> 35;
+    m.low *= PRIME_MX2;
+    m.low ^= m.low >> 28;
+    m.high = xxh3_avalanche(m.high);
+    return m;
+}
+
+Hash len_9to16(const char* input, std::size_t size) {
+    std::uint64_t bitflip_l = read64(SECRET + 32) ^ read64(SECRET + 40);
+    std::uint64_t bitflip_h = read64(SECRET + 48) ^ read64(SECRET + 56);
+    std::uint64_t input_lo = read64(input);
+    std::uint64_t input_hi = read64(input + size - 8);
+    auto m = mult64to128(input_lo ^ input_hi ^ bitflip_l, PRIME64_1);
+    m.low += static_cast<std::uint64_t>(size - 1) << 54;
+    input_hi ^= bitflip_h;
+    m.high += input_hi + static_cast<std::uint64_t>(static_cast<std::uint32_t>(input_hi)) * (PRIME32_2 - 1);
+    m.low ^= __builtin_bswap64(m.high);
+    auto h = mult64to128(m.low, PRIME64_2);
+    h.high += m.high * PRIME64_2;
+    return {xxh3_avalanche(h.low), xxh3_avalanche(h.high)};
+}
+
+Hash len_0to16(const char* input, std::size_t size) {
+    if (size > 8) return len_9to16(input, size);
+    if (size >= 4) return len_4to8(input, size);
+    if (size > 0) return len_1to3(input, size);
+    return {xxh64_avalanche(read64(SECRET + 64) ^ read64(SECRET + 72)),
+            xxh64_avalanche(read64(SECRET + 80) ^ read64(SECRET + 88))};
+}
+
+Hash len_17to128(const char* input, std::size_t size) {
+    Hash acc{size * PRIME64_1, 0};
+    if (size > 32) {
+        if (size > 64) {
+            if (size > 96) {
+                acc = mix32b(acc, input + 48, input + size - 64, SECRET + 96);
+            }
+            acc = mix32b(acc, input + 32, input + size - 48, SECRET + 64);
+        }
+        acc = mix32b(acc, input + 16, input + size - 32, SECRET + 32);
+    }
+    acc = mix32b(acc, input, input + size - 16, SECRET);
+    return finalize_mid(acc, size);
+}
+
+Hash len_129to240(const char* input, std::size_t size) {
+    Hash acc{size * PRIME64_1, 0};
+    std::size_t rounds = size / 32;
+    for (std::size_t i = 0; i < 4; ++i) {
+        acc = mix32b(acc, input + 32 * i, input + 32 * i + 16, SECRET + 32 * i);
+    }
+    acc.low = xxh3_avalanche(acc.low);
+    acc.high = xxh3_avalanche(acc.high);
+    for (std::size_t i = 4; i < rounds; ++i) {
+        acc = mix32b(acc, input + 32 * i, input + 32 * i + 16,
+                SECRET + MIDSIZE_STARTOFFSET + 32 * (i - 4));
+    }
+    acc = mix32b(acc, input + size - 16, input + size - 32,
+            SECRET + SECRET_SIZE_MIN - MIDSIZE_LASTOFFSET - 16);
+    return finalize_mid(acc, size);
+}
+
+void accumulate_512(std::uint64_t* acc, const char* input, const unsigned char* secret) {
+    for (std::size_t i = 0; i < ACC_NB; ++i) {
+        auto data_val = read64(input + 8 * i);
+        auto data_key = data_val ^ read64(secret + 8 * i);
+        acc[i ^ 1] += data_val;
+        acc[i] += (data_key & 0xFFFFFFFFull) * (data_key >> 32);
+    }
+}
+
+void accumulate(std::uint64_t* acc, const char* input, std::size_t stripes) {
+    for (std::size_t n = 0; n < stripes; ++n) {
+        accumulate_512(acc, input + n * STRIPE_LEN, SECRET + n * SECRET_CONSUME_RATE);
+    }
+}
+
+void scramble(std::uint64_t* acc, const unsigned char* secret) {
+    for (std::size_t i = 0; i < ACC_NB; ++i) {
+        auto a = acc[i];
+        a ^= a >> 47;
+        a ^= read64(secret + 8 * i);
+        a *= PRIME32_1;
+        acc[i] = a;
+    }
+}
+
+std::uint64_t merge_accs(const std::uint64_t* acc, const unsigned char* secret, std::uint64_t start) {
+    auto res = start;
+    for (std::size_t i = 0; i < 4; ++i) {
+        res += mul128_fold64(acc[2 * i] ^ read64(secret + 16 * i),
+                acc[2 * i + 1] ^ read64(secret + 16 * i + 8));
+    }
+    return xxh3_avalanche(res);
+}
+
+Hash len_long(const char* input, std::size_t size) {
+    alignas(64) std::uint64_t acc[ACC_NB] = {PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3,
+                                             PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1};
+    constexpr std::size_t stripes_per_block = (SECRET_SIZE - STRIPE_LEN) / SECRET_CONSUME_RATE;
+    constexpr std::size_t block_len = STRIPE_LEN * stripes_per_block;
+    std::size_t blocks = (size - 1) / block_len;
+    for (std::size_t n = 0; n < blocks; ++n) {
+        accumulate(acc, input + n * block_len, stripes_per_block);
+        scramble(acc, SECRET + SECRET_SIZE - STRIPE_LEN);
+    }
+    std::size_t stripes = ((size - 1) - block_len * blocks) / STRIPE_LEN;
+    accumulate(acc, input + blocks * block_len, stripes);
+    accumulate_512(acc, input + size - STRIPE_LEN,
+            SECRET + SECRET_SIZE - STRIPE_LEN - SECRET_LASTACC_START);
+    return {merge_accs(acc, SECRET + SECRET_MERGEACCS_START, size * PRIME64_1),
+            merge_accs(acc, SECRET + SECRET_SIZE - sizeof(acc) - SECRET_MERGEACCS_START,
+                    ~(size * PRIME64_2))};
+}
+
+} // namespace
+
+Hash xxh3_128(const char* data, std::size_t size) {
+    if (size <= 16) return len_0to16(data, size);
+    if (size <= 128) return len_17to128(data, size);
+    if (size <= MIDSIZE_MAX) return len_129to240(data, size);
+    return len_long(data, size);
+}
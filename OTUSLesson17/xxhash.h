@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hash_value.h"
+
+/**
+ * XXH3 128-bit hash (xxHash v0.8 compatible, default secret and seed 0),
+ * scalar implementation without dependency on libxxhash
+ */
+Hash xxh3_128(const char* data, std::size_t size);
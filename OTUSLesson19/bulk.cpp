@@ -6,23 +6,51 @@
 
 using namespace std;
 
-BulkCmdManager::BulkCmdManager(std::size_t bulk_max_size)
+BulkCmdManager::BulkCmdManager(std::size_t bulk_max_size, std::chrono::milliseconds max_latency)
     : bulk_capacity_(bulk_max_size),
       bulk_handler_(std::make_unique<GeneralStateHandler>()),
       cout_tread_pool_(1, "log"),
-      file_tread_pool_(THREADS_NUM, "file")
+      file_tread_pool_(THREADS_NUM, "file"),
+      max_latency_(max_latency),
+      timer_(max_latency.count() > 0 ? FlushTimer::instance() : nullptr)
 {
 }
 
+BulkCmdManager::~BulkCmdManager() {
+    if (timer_) timer_->cancel(this);
+}
+
 void BulkCmdManager::subscribe(ObserverHolder obs) {
     subs_.push_back(move(obs));
 }
 
 void BulkCmdManager::add_cmd(Command cmd) {
+    lock_guard lk(mtx_);
     if (cmd.cmd_type != CommandType::Terminator) ++main_metric_.line_num;
     bulk_handler_->handle_cmd(this, std::move(cmd));
 }
 
+void BulkCmdManager::start_bulk() {
+    cur_bulk_.time_ = time(nullptr);
+    if (timer_) {
+        bulk_start_ = FlushTimer::Clock::now();
+        timer_->schedule(this, bulk_start_ + max_latency_);
+    }
+}
+
+void BulkCmdManager::on_timer(FlushTimer::Clock::time_point now) {
+    lock_guard lk(mtx_);
+    // block is flushed on its closing brace only
+    if (nesting_counter_ > 0 || cur_bulk_.empty()) return;
+    auto deadline = bulk_start_ + max_latency_;
+    if (now >= deadline) {
+        flush_data();
+    } else {
+        // the entry was armed for the previous bulk
+        timer_->schedule(this, deadline);
+    }
+}
+
 void BulkCmdManager::flush_data() {
     if (cur_bulk_.empty()) return;
     auto data_ptr = make_shared<BulkCmd>(std::move(cur_bulk_));
@@ -60,7 +88,7 @@ void BulkCmdManager::notify(BulkCmdHolder bulk_cmd) {
 void GeneralStateHandler::handle_cmd(BulkCmdManager *m, Command cmd) {
     switch (cmd.cmd_type) {
         case CommandType::Base:
-            if (m->cur_bulk_.empty()) {m->cur_bulk_.time_ = time(nullptr);}
+            if (m->cur_bulk_.empty()) {m->start_bulk();}
             m->cur_bulk_.data_.push_back(std::move(cmd));
             if (m->cur_bulk_.data_.size() == m->bulk_capacity_) {m->flush_data();}
             ++m->main_metric_.command_num;
@@ -4,15 +4,19 @@
 
     Bulk command manager can accumulate commands in inner buffer.
     If buffer size is equal its capacity, it will flush buffer to its subscribers.
+    Optionally the bulk is flushed when its oldest command is older than max latency.
 */
 
+#include <chrono>
 #include <vector>
 #include <deque>
 #include <string>
 #include <memory>
+#include <mutex>
 #include <thread>
 
 #include "command.h"
+#include "flush_timer.h"
 #include "thread_pool.h"
 #include "metrics.h"
 
@@ -49,14 +53,20 @@ public:
  *
  * Bulk command manager can accumulate commands in inner buffer (method add_cmd).
  * If buffer size is equal its capacity (max_size), it will flush buffer to its subscribers (notify them).
- * It obtains bulk capacity (max_size) in ctor
+ * It obtains bulk capacity (max_size) in ctor.
+ * If max_latency is not zero, the bulk is also flushed by the shared FlushTimer when its first command
+ * is older than max_latency. A block {} isn't split, it's flushed on its closing brace as before.
  */
-class BulkCmdManager {
+class BulkCmdManager final : private FlushTimer::Client {
 public:
     friend class GeneralStateHandler;
     friend class CustomStateHandler;
 public:
-    explicit BulkCmdManager(std::size_t bulk_max_size);
+    explicit BulkCmdManager(std::size_t bulk_max_size,
+                            std::chrono::milliseconds max_latency = std::chrono::milliseconds(0));
+    ~BulkCmdManager();
+    BulkCmdManager(const BulkCmdManager&) = delete;
+    BulkCmdManager& operator=(const BulkCmdManager&) = delete;
     void subscribe(ObserverHolder obs);
     void add_cmd(Command cmd);
     void print_metric(std::ostream& out) const;
@@ -70,9 +80,15 @@ private:
     ThreadPool cout_tread_pool_;
     ThreadPool file_tread_pool_;
     MainMetric main_metric_;
+    std::chrono::milliseconds max_latency_;
+    FlushTimer::Clock::time_point bulk_start_;  ///< time of the first command of the current bulk
+    std::shared_ptr<FlushTimer> timer_;         ///< only if max latency is set
+    std::mutex mtx_;                            ///< add_cmd vs timer flush
     // methods
     void flush_data();
     void notify(BulkCmdHolder bulk_cmd);
+    void start_bulk();
+    void on_timer(FlushTimer::Clock::time_point now) override;
 };
 
 /**
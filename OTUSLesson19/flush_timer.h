@@ -0,0 +1,76 @@
+#pragma once
+/**@file
+    @brief Timer wheel of bulk flushes
+
+    One thread serves deadlines of all bulk managers
+*/
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Hashed timer wheel
+ *
+ * Deadline falls into slot (deadline in ticks) % slots count, every tick the thread
+ * fires expired entries of the current slot, entries of later rounds stay in it.
+ * Client has at most one entry: schedule moves it. Thread sleeps while there are no entries,
+ * otherwise till the tick of the first not empty slot, so empty ticks don't wake it.
+ * After cancel returns the client isn't called any more.
+ */
+class FlushTimer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// timer client, on_timer is called in the timer thread
+    class Client {
+    public:
+        virtual void on_timer(Clock::time_point now) = 0;
+    protected:
+        ~Client() = default;
+    };
+
+    explicit FlushTimer(std::chrono::milliseconds tick = std::chrono::milliseconds(1), std::size_t slots_count = 1024);
+    ~FlushTimer();
+    FlushTimer(const FlushTimer&) = delete;
+    FlushTimer& operator=(const FlushTimer&) = delete;
+
+    /// timer shared by all bulk managers, managers hold it
+    static std::shared_ptr<FlushTimer> instance();
+
+    void schedule(Client* client, Clock::time_point deadline);
+    void cancel(Client* client);
+private:
+    struct Entry {
+        Client* client;
+        Clock::time_point deadline;
+    };
+
+    Clock::duration tick_;
+    Clock::time_point start_;
+    std::vector<std::vector<Entry>> slots_;
+    std::unordered_map<Client*, std::size_t> client_slots_;
+    std::size_t next_tick_ = 0;     ///< the first not processed tick
+    static constexpr std::size_t NO_TICK = std::numeric_limits<std::size_t>::max();
+    std::size_t wake_tick_ = NO_TICK;   ///< tick the thread sleeps till
+    bool stop_ = false;
+    std::mutex run_mtx_;            ///< held while clients are called
+    std::mutex mtx_;                ///< guards entries, it's locked after run_mtx_ and clients' locks
+    std::condition_variable cv_;
+    std::thread worker_;
+    // methods
+    /// the first tick not earlier than time
+    [[nodiscard]] std::size_t tickOf(Clock::time_point time) const;
+    /// the last tick not later than time
+    [[nodiscard]] std::size_t passedTick(Clock::time_point time) const;
+    /// the first tick from next_tick_ with not empty slot
+    [[nodiscard]] std::size_t nextBusyTick() const;
+    void remove(Client* client);
+    void run();
+};
@@ -1,3 +1,4 @@
+#include <chrono>
 #include <iostream>
 #include <memory>
 #include <vector>
@@ -12,22 +13,27 @@ using namespace std;
 
 int main(int argc, char* argv[]) {
     if (argc < 2) {
-        cerr << "Incorrect parameter number. Bulk must have one parameter: bulk size" << endl;
+        cerr << "Incorrect parameter number. Usage: bulkmt <bulk size> [max latency ms]" << endl;
         return -1;
     }
     size_t bulk_size = 0;
-    try {
-        bulk_size = stol(argv[1]);
-    } catch (const std::exception& e) {
-        cerr << "'" << argv[1] << "'" << " is not a number. Cmd paramenter must be a number. ";
-        cerr << e.what() << endl;
-        return -2;
+    chrono::milliseconds max_latency(0);
+    for (int i = 1; i < argc && i < 3; ++i) {
+        try {
+            auto value = stol(argv[i]);
+            if (i == 1) bulk_size = value;
+            else max_latency = chrono::milliseconds(value);
+        } catch (const std::exception& e) {
+            cerr << "'" << argv[i] << "'" << " is not a number. Cmd paramenter must be a number. ";
+            cerr << e.what() << endl;
+            return -2;
+        }
     }
     
     // init
     stringstream out;
     {
-        auto bulkMgr = make_unique<BulkCmdManager>(bulk_size);
+        auto bulkMgr = make_unique<BulkCmdManager>(bulk_size, max_latency);
         auto commandReader = make_unique<StreamCmdReader>(cin);
         createObserverAndSubscribe<CmdStreamHandler>(bulkMgr.get());
         createObserverAndSubscribe<CmdFileHandler>(bulkMgr.get());
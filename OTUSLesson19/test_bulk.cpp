@@ -2,6 +2,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <thread>
 #include <chrono>
@@ -10,6 +11,7 @@
 #include "command_reader.h"
 #include "command_handler.h"
 #include "command_processor.h"
+#include "flush_timer.h"
 #include "simple_math.h"
 #include "thread_pool.h"
 
@@ -214,4 +216,115 @@ BOOST_AUTO_TEST_SUITE(thread_pool_test_suite)
         }
     }
 
-BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE(max_latency_test_suite)
+
+    using Clock = FlushTimer::Clock;
+
+    class TimerClient : public FlushTimer::Client {
+    public:
+        void on_timer(Clock::time_point now) override {
+            lock_guard lk(mtx_);
+            fired_.push_back(now);
+        }
+        vector<Clock::time_point> fired() {
+            lock_guard lk(mtx_);
+            return fired_;
+        }
+    private:
+        mutex mtx_;
+        vector<Clock::time_point> fired_;
+    };
+
+    /// remembers flush time of every bulk
+    class FlushRecorder : public IObserver {
+    public:
+        void update(BulkCmdHolder bulk) override {
+            auto now = Clock::now();
+            lock_guard lk(mtx_);
+            flushes_.emplace_back(now, bulk->data_.size());
+        }
+        vector<pair<Clock::time_point, size_t>> flushes() {
+            lock_guard lk(mtx_);
+            return flushes_;
+        }
+    private:
+        mutex mtx_;
+        vector<pair<Clock::time_point, size_t>> flushes_;
+    };
+
+    constexpr auto SLACK = 40ms;
+
+    BOOST_AUTO_TEST_CASE(test_flush_timer) {
+        FlushTimer timer(1ms, 16);
+        TimerClient early, late, moved, canceled;
+        auto start = Clock::now();
+        // late deadline is several rounds of the wheel later
+        timer.schedule(&late, start + 60ms);
+        timer.schedule(&early, start + 20ms);
+        timer.schedule(&moved, start + 10ms);
+        timer.schedule(&moved, start + 40ms);
+        timer.schedule(&canceled, start + 10ms);
+        timer.cancel(&canceled);
+        this_thread::sleep_for(60ms + SLACK * 2);
+
+        BOOST_CHECK(canceled.fired().empty());
+        auto check = [start](TimerClient& client, chrono::milliseconds delay) {
+            auto fired = client.fired();
+            BOOST_REQUIRE(fired.size() == 1);
+            BOOST_CHECK(fired[0] >= start + delay);
+            BOOST_CHECK(fired[0] <= start + delay + SLACK);
+        };
+        check(early, 20ms);
+        check(moved, 40ms);
+        check(late, 60ms);
+    }
+
+    BOOST_AUTO_TEST_CASE(test_max_latency) {
+        constexpr auto T = 50ms;
+        auto recorder = make_shared<FlushRecorder>();
+        vector<Clock::time_point> added;
+        {
+            BulkCmdManager bulkMgr(100, T);
+            bulkMgr.subscribe(recorder);
+            // slow stream: a command every 15 ms, bulk is never full
+            for (int i = 0; i < 12; ++i) {
+                added.push_back(Clock::now());
+                bulkMgr.add_cmd(Command{CommandType::Base, to_string(i)});
+                this_thread::sleep_for(15ms);
+            }
+            this_thread::sleep_for(T + SLACK);
+        }
+        auto flushes = recorder->flushes();
+        BOOST_REQUIRE(flushes.size() > 1);
+        size_t first = 0;
+        for (const auto& [time, size] : flushes) {
+            // the oldest command of the bulk waited T, but not much longer
+            BOOST_CHECK(time - added[first] >= T);
+            BOOST_CHECK(time - added[first] <= T + SLACK);
+            first += size;
+        }
+        BOOST_CHECK(first == added.size());
+    }
+
+    BOOST_AUTO_TEST_CASE(test_max_latency_block) {
+        constexpr auto T = 20ms;
+        auto recorder = make_shared<FlushRecorder>();
+        {
+            BulkCmdManager bulkMgr(100, T);
+            bulkMgr.subscribe(recorder);
+            bulkMgr.add_cmd(Command{CommandType::StartCustomBulk, "{"});
+            bulkMgr.add_cmd(Command{CommandType::Base, "1"});
+            this_thread::sleep_for(T * 3);
+            // block isn't split by timeout
+            BOOST_CHECK(recorder->flushes().empty());
+            bulkMgr.add_cmd(Command{CommandType::Base, "2"});
+            bulkMgr.add_cmd(Command{CommandType::StopCustomBulk, "}"});
+            this_thread::sleep_for(T * 3);
+        }
+        auto flushes = recorder->flushes();
+        BOOST_REQUIRE(flushes.size() == 1);
+        BOOST_CHECK(flushes[0].second == 2);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
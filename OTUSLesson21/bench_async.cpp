@@ -0,0 +1,176 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bulk.h"
+#include "command_handler.h"
+#include "command_processor.h"
+#include "connection_pool.h"
+#include "ts_cont.h"
+
+using namespace std;
+
+namespace {
+
+/// counts commands of all bulks, no output
+class CountingHandler : public IObserver {
+public:
+    explicit CountingHandler(std::atomic<std::size_t>& counter)
+        : counter_(counter) {}
+
+    void update(BulkCmdHolder bulk_holder) override {
+        counter_.fetch_add(bulk_holder->size(), std::memory_order_relaxed);
+    }
+private:
+    std::atomic<std::size_t>& counter_;
+};
+
+/// receive and disconnect of the library before sharding: lookup in the map, processing under the connection mutex
+class LockedPath {
+public:
+    void* connect(std::size_t bulk_size, std::atomic<std::size_t>& counter) {
+        auto connection = make_unique<LockedConnection>(bulk_size);
+        createObserverAndSubscribe<CountingHandler>(connection->processor.getBulkMgr().get(), counter);
+        return reinterpret_cast<void*>(connections_.push(std::move(connection)));
+    }
+
+    void receive(void* handle, const char* data, std::size_t size) {
+        auto idx = reinterpret_cast<std::size_t>(handle);
+        if (connections_.contains(idx)) {
+            auto& connection = *connections_[idx];
+            auto& dataProcessor = connection.processor;
+            lock_guard lk(connection.mtx);
+            dataProcessor.feed(data, size);
+            process_all_commands(dataProcessor.getcmdReader(), *dataProcessor.getBulkMgr());
+        }
+    }
+
+    void disconnect(void* handle) {
+        auto idx = reinterpret_cast<std::size_t>(handle);
+        {
+            auto& connection = *connections_[idx];
+            auto& dataProcessor = connection.processor;
+            lock_guard lk(connection.mtx);
+            if (!dataProcessor.getcmdReader().isCmdComplete()) {
+                dataProcessor.getBulkMgr()->add_cmd(dataProcessor.getcmdReader().read_next_cmd());
+            }
+            dataProcessor.getBulkMgr()->add_cmd(Command{CommandType::Terminator});
+        }
+        connections_.erase(idx);
+    }
+private:
+    struct LockedConnection {
+        explicit LockedConnection(std::size_t bulk_size) : processor(bulk_size) {}
+        CommandProcessor processor;
+        std::mutex mtx;
+    };
+    ThreadSafeUnorderedMap<unique_ptr<LockedConnection>> connections_;
+};
+
+/// sharded processing of the library
+class ShardedPath {
+public:
+    void* connect(std::size_t bulk_size, std::atomic<std::size_t>& counter) {
+        return pool_.connect(bulk_size, [&counter](BulkCmdManager& bulkMgr) {
+            createObserverAndSubscribe<CountingHandler>(&bulkMgr, counter);
+        });
+    }
+
+    void receive(void* handle, const char* data, std::size_t size) {
+        ConnectionPool::receive(static_cast<Connection*>(handle), data, size);
+    }
+
+    void disconnect(void* handle) {
+        ConnectionPool::disconnect(static_cast<Connection*>(handle));
+    }
+private:
+    ConnectionPool pool_;
+};
+
+/// value of /proc/self/status field, e.g. "Threads" or "VmRSS" (kB)
+std::size_t proc_status(const string& key) {
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (line.compare(0, key.size() + 1, key + ":") == 0) {
+            return strtoull(line.c_str() + key.size() + 1, nullptr, 10);
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+// bench_async [packets_count] [producers_count] [bulk_size]
+// every packet is 4 commands, producers send packets to their handles in turn
+int main(int argc, char* argv[]) {
+    std::size_t packets_count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1'000'000;
+    std::size_t producers_count = argc > 2 ? strtoull(argv[2], nullptr, 10) : 4;
+    std::size_t bulk_size = argc > 3 ? strtoull(argv[3], nullptr, 10) : 10;
+    const string packet = "command_1\ncommand_2\ncommand_3\ncommand_4\n";
+    const std::size_t commands_per_packet = 4;
+
+    auto run = [&](const string& name, auto& path, std::size_t handles_count) {
+        std::atomic<std::size_t> commands{0};
+        vector<void*> handles;
+        for (std::size_t i = 0; i < handles_count; ++i) {
+            handles.push_back(path.connect(bulk_size, commands));
+        }
+        auto threads_count = proc_status("Threads");
+        auto rss = proc_status("VmRSS");
+        auto start = chrono::steady_clock::now();
+        vector<thread> producers;
+        for (std::size_t p = 0; p < producers_count; ++p) {
+            producers.emplace_back([&, p] {
+                // handles are split between producers, every handle has one producer
+                std::size_t first = handles_count * p / producers_count;
+                std::size_t last = handles_count * (p + 1) / producers_count;
+                if (first == last) return;
+                std::size_t count = packets_count / producers_count;
+                for (std::size_t i = 0; i < count; ++i) {
+                    path.receive(handles[first + i % (last - first)], packet.data(), packet.size());
+                }
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        auto received = chrono::steady_clock::now();
+        for (auto handle : handles) {
+            path.disconnect(handle);
+        }
+        // sharded path processes the rest on shard threads
+        std::size_t expected = packets_count / producers_count * min(producers_count, handles_count) * commands_per_packet;
+        while (commands.load() < expected) {
+            this_thread::yield();
+        }
+        auto done = chrono::steady_clock::now();
+
+        chrono::duration<double> receive_time = received - start;
+        chrono::duration<double> total_time = done - start;
+        auto packets = static_cast<double>(expected / commands_per_packet);
+        cout << name << ", " << handles_count << " handles: "
+             << packets / receive_time.count() << " receive calls/s, "
+             << packets / total_time.count() << " packets/s processed, "
+             << threads_count << " threads, " << rss / 1024 << " MiB RSS\n";
+    };
+
+    for (std::size_t handles_count : {1, 10, 100, 1000, 10000}) {
+        {
+            LockedPath path;
+            run("mutex per connection", path, handles_count);
+        }
+        {
+            ShardedPath path;
+            run("sharded", path, handles_count);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "bulk.h"
+#include "command_handler.h"
+#include "command_processor.h"
+#include "command_reader.h"
+
+using namespace std;
+
+namespace {
+
+std::atomic<std::size_t> allocations_count{0};
+
+/// stream buffer which drops all output
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override {return c;}
+    std::streamsize xsputn(const char*, std::streamsize n) override {return n;}
+};
+
+/// observer which drops bulks
+class NullObserver : public IObserver {
+public:
+    void update(BulkCmdHolder) override {}
+};
+
+/// parsed commands, nested blocks every 8 lines: { c { c } c } c
+std::vector<Command> make_nested_commands(std::size_t lines_count) {
+    static const Command pattern[] = {
+        {CommandType::StartCustomBulk, "{"}, {CommandType::Base, "cmd1"},
+        {CommandType::StartCustomBulk, "{"}, {CommandType::Base, "cmd2"},
+        {CommandType::StopCustomBulk, "}"}, {CommandType::Base, "cmd3"},
+        {CommandType::StopCustomBulk, "}"}, {CommandType::Base, "cmd4"}
+    };
+    std::vector<Command> commands;
+    commands.reserve(lines_count);
+    for (std::size_t i = 0; i < lines_count; ++i) {
+        commands.push_back(pattern[i % std::size(pattern)]);
+    }
+    return commands;
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    allocations_count.fetch_add(1, std::memory_order_relaxed);
+    if (auto p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+// bench_bulk [lines_count] [bulk_size] [packet_size]
+int main(int argc, char* argv[]) {
+    std::size_t lines_count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 10'000'000;
+    std::size_t bulk_size = argc > 2 ? strtoull(argv[2], nullptr, 10) : 10;
+    std::size_t packet_size = argc > 3 ? strtoull(argv[3], nullptr, 10) : 1000;
+
+    // every 100 lines there is a nested block
+    string input;
+    for (std::size_t i = 0; i < lines_count; ++i) {
+        switch (i % 100) {
+            case 50: case 52: input += "{\n"; break;
+            case 60: case 62: input += "}\n"; break;
+            // longer than short string buffer
+            default: input += "command_" + to_string(i) + "_payload\n";
+        }
+    }
+    NullBuffer null_buffer;
+    ostream null_out(&null_buffer);
+    ofstream dev_null("/dev/null");
+    int dev_null_fd = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+
+    auto measure = [&](const string& name, auto body) {
+        auto allocations_before = allocations_count.load();
+        auto start = chrono::steady_clock::now();
+        body();
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        auto allocations = allocations_count.load() - allocations_before;
+
+        cout << name << ", " << lines_count << " lines, bulk size " << bulk_size << ": "
+             << elapsed.count() << " s, "
+             << static_cast<double>(lines_count) / elapsed.count() << " lines/s, "
+             << static_cast<double>(allocations) / static_cast<double>(lines_count)
+             << " allocations per line\n";
+    };
+
+    auto run = [&](const string& name, auto subscribe) {
+        istringstream in(input);
+        measure(name, [&] {
+            BulkCmdManager bulkMgr(bulk_size);
+            StreamCmdReader commandReader(in);
+            subscribe(bulkMgr);
+            process_all_commands(commandReader, bulkMgr);
+        });
+    };
+
+    run("stream without output", [&](BulkCmdManager& bulkMgr) {
+        createObserverAndSubscribe<CmdStreamHandler>(&bulkMgr, null_out);
+    });
+    // write and flush per bulk
+    run("stream to /dev/null", [&](BulkCmdManager& bulkMgr) {
+        createObserverAndSubscribe<CmdStreamHandler>(&bulkMgr, dev_null);
+    });
+    auto writer = make_shared<BatchedFdWriter>(dev_null_fd, BatchedFdWriter::Options{});
+    run("batched writev to /dev/null", [&](BulkCmdManager& bulkMgr) {
+        createObserverAndSubscribe<CmdConsoleHandler>(&bulkMgr, writer);
+    });
+    cout << "batched writes: " << writer->writesCount() << "\n";
+
+    // async receive path, lines are split between packets
+    measure("receive by " + to_string(packet_size) + " bytes without output", [&] {
+        CommandProcessor processor(bulk_size);
+        createObserverAndSubscribe<CmdStreamHandler>(processor.getBulkMgr().get(), null_out);
+        for (std::size_t pos = 0; pos < input.size(); pos += packet_size) {
+            auto size = min(packet_size, input.size() - pos);
+            processor.feed(input.data() + pos, size);
+            process_all_commands(processor.getcmdReader(), *processor.getBulkMgr());
+        }
+        processor.getBulkMgr()->add_cmd(Command{CommandType::Terminator});
+    });
+
+    // state machine only: commands are parsed, bulks are dropped
+    auto nested_commands = make_nested_commands(lines_count);
+    measure("nested-heavy commands without output", [&] {
+        BulkCmdManager bulkMgr(bulk_size);
+        createObserverAndSubscribe<NullObserver>(&bulkMgr);
+        for (const auto& cmd : nested_commands) {
+            bulkMgr.add_cmd(cmd);
+        }
+        bulkMgr.add_cmd(Command{CommandType::Terminator});
+    });
+    ::close(dev_null_fd);
+    return 0;
+}
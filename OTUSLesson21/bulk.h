@@ -6,94 +6,160 @@
     If buffer size is equal its capacity, it will flush buffer to its subscribers.
 */
 
-#include <vector>
-#include <deque>
-#include <string>
+#include <ctime>
+#include <iterator>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "command.h"
-#include "thread_pool.h"
+#include "observer_pool.h"
 
 #define MULTI_THREAD
 
-/// Bulk of commands
-struct BulkCmd {
+/**
+ * @brief Bulk of commands
+ *
+ * Text of all commands is stored in one buffer (each command is followed by '\n',
+ * the buffer is the content of bulk file), commands are string views into it by the offset table.
+ * Manager reuses its bulk buffers, observers get an immutable compact copy:
+ * building of a bulk costs O(1) allocations instead of one per command.
+ */
+class BulkCmd {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::string_view*;
+        using reference = std::string_view;
+
+        const_iterator(const BulkCmd* bulk, std::size_t idx) : bulk_(bulk), idx_(idx) {}
+        std::string_view operator*() const {return (*bulk_)[idx_];}
+        const_iterator& operator++() {++idx_; return *this;}
+        bool operator==(const const_iterator& other) const {return idx_ == other.idx_;}
+        bool operator!=(const const_iterator& other) const {return idx_ != other.idx_;}
+    private:
+        const BulkCmd* bulk_ = nullptr;
+        std::size_t idx_ = 0;
+    };
+
     std::time_t time_ = 0;
-    std::deque<Command> data_;
-    BulkCmd() = default;
-    BulkCmd(std::time_t time, std::deque<Command>&& data)
-        : time_(time), data_(std::move(data))
-    {}
-    [[nodiscard]] bool empty() const {return data_.empty();}
-    void clear() {data_.clear();}
-    [[nodiscard]] const std::deque<Command>& getData() const {return data_;}
+
+    void add(std::string_view cmd) {
+        text_.append(cmd);
+        text_ += '\n';
+        ends_.push_back(text_.size());
+    }
+    /// clears commands, but keeps memory for the next bulk
+    void clear() {text_.clear(); ends_.clear();}
+    [[nodiscard]] bool empty() const {return ends_.empty();}
+    [[nodiscard]] std::size_t size() const {return ends_.size();}
+    /// command without '\n'
+    [[nodiscard]] std::string_view operator[](std::size_t idx) const {
+        auto begin = idx == 0 ? 0 : ends_[idx - 1];
+        return std::string_view(text_).substr(begin, ends_[idx] - begin - 1);
+    }
+    /// all commands, every one is followed by '\n'
+    [[nodiscard]] std::string_view text() const {return text_;}
+    [[nodiscard]] const_iterator begin() const {return {this, 0};}
+    [[nodiscard]] const_iterator end() const {return {this, ends_.size()};}
+private:
+    std::string text_;
+    std::vector<std::size_t> ends_;
 };
 
 /// Command bulk holder
-using BulkCmdHolder = std::shared_ptr<BulkCmd>;
+using BulkCmdHolder = std::shared_ptr<const BulkCmd>;
 
 class IObserver;
 using ObserverHolder = std::shared_ptr<IObserver>;
 
-/**
- *  @brief State machine for Bulk manager
- *
- * Interface for Bulk manager state machine
- */
-class BulkStateHandler {
-public:
-    virtual ~BulkStateHandler() = default;
-    virtual void handle_cmd(class BulkCmdManager* m, Command cmd) = 0;
-};
-
 /**
  *  @brief Bulk command manager
  *
  * Bulk command manager can accumulate commands in inner buffer (method add_cmd).
  * If buffer size is equal its capacity (max_size), it will flush buffer to its subscribers (notify them).
- * It obtains bulk capacity (max_size) in ctor
+ * It obtains bulk capacity (max_size) in ctor.
+ * Manager is a state machine of two states (BulkState): the state is a plain enum, so transitions
+ * don't allocate and add_cmd is inlined into the reading loop.
  */
 class BulkCmdManager {
-public:
-    friend class GeneralStateHandler;
-    friend class CustomStateHandler;
 public:
     explicit BulkCmdManager(std::size_t bulk_max_size);
     void subscribe(ObserverHolder obs);
-    void add_cmd(Command cmd);
+    void add_cmd(Command cmd) {
+        switch (state_) {
+            case BulkState::General: handle_general(cmd); break;
+            case BulkState::Custom: handle_custom(cmd); break;
+        }
+    }
 private:
-    static constexpr std::size_t THREADS_NUM = 2;
+    /**
+     * General: manager accumulates to buffer until size < buffer capacity
+     * Custom: manager accumulates to buffer until stop command of the outer block will arrive
+     */
+    enum class BulkState {General, Custom};
+
     std::size_t bulk_capacity_ = 0;
     int nesting_counter_ = 0;
+    BulkState state_ = BulkState::General;
     std::vector<ObserverHolder> subs_;
     BulkCmd cur_bulk_;
-    std::unique_ptr<BulkStateHandler> bulk_handler_ = nullptr;
 #ifdef MULTI_THREAD
-    ThreadPool cout_tread_pool_;
-    ThreadPool file_tread_pool_;
+    // queues of the shared pools keep the order of bulks of this manager
+    ObserverQueue log_queue_;
+    ObserverQueue file_queue_;
 #endif
     // methods
+    void handle_general(const Command& cmd);
+    void handle_custom(const Command& cmd);
     void flush_data();
     void notify(BulkCmdHolder bulk_cmd);
 };
 using BulkMgrHolder = std::unique_ptr<BulkCmdManager>;
 
-/**
- *  @brief State machine for Bulk manager
- *
- * State machine implementation. General state: Bulk manager accumulate to buffer until size < buffer capacity
- */
-class GeneralStateHandler : public BulkStateHandler {
-public:
-    void handle_cmd(BulkCmdManager* m, Command cmd) override;
-};
+inline void BulkCmdManager::handle_general(const Command& cmd) {
+    switch (cmd.cmd_type) {
+        case CommandType::Base:
+            if (cur_bulk_.empty()) {cur_bulk_.time_ = std::time(nullptr);}
+            cur_bulk_.add(cmd.data);
+            if (cur_bulk_.size() == bulk_capacity_) {flush_data();}
+            break;
+        case CommandType::StartCustomBulk:
+            flush_data();
+            state_ = BulkState::Custom;
+            ++nesting_counter_;
+            break;
+        case CommandType::StopCustomBulk:
+            break;
+        case CommandType::Terminator:
+            flush_data();
+            break;
+    }
+}
 
-/**
- *  @brief State machine for Bulk manager
- *
- * State machine implementation. Custom state: Bulk manager accumulate to buffer until stop command will arrive
- */
-class CustomStateHandler : public BulkStateHandler {
-public:
-    void handle_cmd(BulkCmdManager* m, Command cmd) override;
-};
\ No newline at end of file
+inline void BulkCmdManager::handle_custom(const Command& cmd) {
+    switch (cmd.cmd_type) {
+        case CommandType::Base:
+            if (cur_bulk_.empty()) {cur_bulk_.time_ = std::time(nullptr);}
+            cur_bulk_.add(cmd.data);
+            break;
+        case CommandType::StartCustomBulk:
+            ++nesting_counter_;
+            break;
+        case CommandType::StopCustomBulk:
+            --nesting_counter_;
+            if (nesting_counter_ == 0) {
+                flush_data();
+                state_ = BulkState::General;
+            }
+            break;
+        case CommandType::Terminator:
+            //empty buffer
+            cur_bulk_.clear();
+            break;
+    }
+}
@@ -4,15 +4,16 @@
 */
 
 #include <ctime>
+#include <string_view>
 
 enum class CommandType {Base, StartCustomBulk, StopCustomBulk, Terminator};
 
 /**
  *  @brief Command structure
  *
- *  time -- command arrival time
+ *  data -- view into the reader buffer, it's valid until the next read
  */
 struct Command {
     CommandType cmd_type = CommandType::Base;
-    std::string data;
+    std::string_view data;
 };
@@ -1,7 +1,6 @@
 #include "command_handler.h"
 
 #include <fstream>
-#include <sstream>
 
 #include <thread>
 
@@ -9,29 +8,38 @@ using namespace std;
 
 std::atomic<int> CmdFileHandler::counter_ = 0;
 
-void CmdStreamHandler::update(BulkCmdHolder bulk_holder) {
-    stringstream buf;
-    buf << "bulk: ";
+void formatBulk(std::string& out, const BulkCmd& bulk) {
+    out += "bulk: ";
     bool is_first = true;
-    for (const auto& c : bulk_holder->getData()) {
+    for (auto cmd : bulk) {
         if (is_first) {
             is_first = false;
         } else {
-            buf << ", ";
+            out += ", ";
         }
-        buf << c.data;
+        out += cmd;
     }
-    buf << '\n';
-    out_ << buf.str();
+    out += '\n';
+}
+
+void CmdStreamHandler::update(BulkCmdHolder bulk_holder) {
+    // whole bulk is written at once, buffer is reused
+    buffer_.clear();
+    formatBulk(buffer_, *bulk_holder);
+    out_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
     out_.flush();
 }
 
+void CmdConsoleHandler::update(BulkCmdHolder bulk_holder) {
+    writer_->append([&bulk = *bulk_holder](std::string& out) {
+        formatBulk(out, bulk);
+    });
+}
+
 void CmdFileHandler::update(BulkCmdHolder bulk_holder) {
     const auto& bulk = *bulk_holder;
     ofstream out(getFileName(bulk));
-    for (const auto& c : bulk.getData()) {
-        out << c.data << '\n';
-    }
+    out << bulk.text();
 }
 
 std::string CmdFileHandler::getFileName(const BulkCmd& bulk) {
@@ -11,6 +11,7 @@
 #include <atomic>
 
 #include "bulk.h"
+#include "console_writer.h"
 
 /**
  * @brief Subscriber interface.
@@ -38,8 +39,28 @@ public:
     void update(BulkCmdHolder bulk_holder) override;
 private:
     std::ostream& out_;
+    std::string buffer_;
 };
 
+/**
+ * @brief Command handler implementation. Outputs to console via batched writer.
+ *
+ * Output format is the same as CmdStreamHandler's, but bulks aren't written one by one:
+ * writer coalesces them into one writev with latency bound. Writer can be shared by handlers.
+ */
+class CmdConsoleHandler : public IObserver {
+public:
+    explicit CmdConsoleHandler(FdWriterHolder writer)
+        : writer_(std::move(writer)) {}
+
+    void update(BulkCmdHolder bulk_holder) override;
+private:
+    FdWriterHolder writer_;
+};
+
+/// appends "bulk: cmd1, cmd2, ...\n" to out
+void formatBulk(std::string& out, const BulkCmd& bulk);
+
 /**
  * @brief Command handler implementation. Outputs to file.
  *
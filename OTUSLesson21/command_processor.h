@@ -1,9 +1,6 @@
 #pragma once
 
-#include <deque>
-#include <utility>
-#include <string>
-#include <mutex>
+#include <memory>
 
 #include "bulk.h"
 #include "command_reader.h"
@@ -11,22 +8,18 @@
 class CommandProcessor {
 public:
     explicit CommandProcessor(std::size_t bulk_size)
-    :   cmdReader_(std::make_unique<QueueReader>(buffer_)),
-        bulkMgr_(std::make_unique<BulkCmdManager>(bulk_size))
+    :   bulkMgr_(std::make_unique<BulkCmdManager>(bulk_size))
     {}
 
-    void pushToBuffer(const char* data, std::size_t data_size);
+    /// received data is read in place, it must be valid until all commands are processed
+    void feed(const char* data, std::size_t data_size) {cmdReader_.feed(data, data_size);}
 
     // getters
-    std::deque<std::string>& getBuffer() {return buffer_;}
-    ICmdReader& getcmdReader() {return *cmdReader_;}
+    ICmdReader& getcmdReader() {return cmdReader_;}
     BulkMgrHolder& getBulkMgr() {return bulkMgr_;}
-    std::mutex& getMutex() {return mtx_;}
 private:
-    std::deque<std::string> buffer_;
-    std::unique_ptr<ICmdReader> cmdReader_;
+    ChunkCmdReader cmdReader_;
     BulkMgrHolder bulkMgr_;
-    std::mutex mtx_;
 };
 
 void process_all_commands(ICmdReader& cmdReader, BulkCmdManager& bulkMgr);
\ No newline at end of file
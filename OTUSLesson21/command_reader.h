@@ -7,8 +7,8 @@
 
 #include <iostream>
 #include <memory>
-#include <deque>
 #include <string>
+#include <string_view>
 
 #include "command.h"
 
@@ -24,14 +24,15 @@ public:
     virtual bool hasCmd() = 0;
     virtual bool isCmdComplete() = 0;
 protected:
-    static Command getCmd(std::string cmd_line);
+    static Command getCmd(std::string_view cmd_line);
 };
 using CmdReaderHolder = std::unique_ptr<ICmdReader>;
 
 /**
  *  @brief Command reader from input stream
  *
- *  Command reader implementation. Obtains stream in ctor and reads command, separated by eol
+ *  Command reader implementation. Obtains stream in ctor and reads command, separated by eol.
+ *  Line buffer is reused, command data is valid until the next read
  */
 class StreamCmdReader : public ICmdReader{
 public:
@@ -41,18 +42,27 @@ public:
     bool isCmdComplete() override {return true;}
 private:
     std::istream& in_;
+    std::string line_;
 };
 
-class QueueReader : public ICmdReader {
+/**
+ *  @brief Incremental command reader from received chunks
+ *
+ *  Commands are views into the fed chunk, eol is searched with memchr.
+ *  Only the partial line at the end of a chunk is copied, it's completed by the next chunk.
+ *  Command data is valid until the next read
+ */
+class ChunkCmdReader : public ICmdReader {
 public:
-    explicit QueueReader(std::deque<std::string>& buffer)
-        : buffer_(buffer)
-    {}
+    /// chunk isn't copied, it must be valid until hasCmd() returns false
+    void feed(const char* data, std::size_t size);
+    /// complete line, or the partial line when there is no complete one
     Command read_next_cmd() override;
     bool hasCmd() override;
-    bool isCmdComplete() override;
+    bool isCmdComplete() override {return tail_.empty() && chunk_.empty();}
 private:
-    std::deque<std::string>& buffer_;
+    std::string_view chunk_;        ///< not read data of the current chunk
+    const char* eol_ = nullptr;     ///< eol in chunk_ found by hasCmd
+    std::string tail_;              ///< partial line of the previous chunks
+    std::string line_;              ///< completed partial line
 };
-
-
@@ -0,0 +1,130 @@
+#include "connection_pool.h"
+
+#include <utility>
+
+using namespace std;
+
+// Connection
+void Connection::enqueue(Packet* packet) {
+    packets_.push(packet);
+    // pairs with the fence of the shard after clearing scheduled_
+    atomic_thread_fence(memory_order_seq_cst);
+    if (!scheduled_.exchange(true)) {
+        shard_.schedule(this);
+    }
+}
+
+bool Connection::process(std::size_t max_packets) {
+    auto& cmdReader = processor_.getcmdReader();
+    auto& bulkMgr = processor_.getBulkMgr();
+    for (std::size_t i = 0; i < max_packets; ++i) {
+        unique_ptr<Packet> packet(packets_.pop());
+        if (!packet) {
+            return false;
+        }
+        if (packet->last) {
+            close();
+        } else {
+            processor_.feed(packet->data.data(), packet->data.size());
+            process_all_commands(cmdReader, *bulkMgr);
+        }
+    }
+    return true;
+}
+
+void Connection::close() {
+    auto& cmdReader = processor_.getcmdReader();
+    auto& bulkMgr = processor_.getBulkMgr();
+    if (!cmdReader.isCmdComplete()) {
+        bulkMgr->add_cmd(cmdReader.read_next_cmd());
+    }
+    bulkMgr->add_cmd(Command{CommandType::Terminator});
+}
+
+// Shard
+Shard::Shard()
+    : worker_(&Shard::run, this)
+{}
+
+Shard::~Shard() {
+    {
+        lock_guard lk(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    worker_.join();
+}
+
+void Shard::schedule(Connection* connection) {
+    connection->addRef();
+    ready_.push(connection);
+    atomic_thread_fence(memory_order_seq_cst);
+    if (waiting_.load(memory_order_relaxed)) {
+        lock_guard lk(mtx_);
+        cv_.notify_one();
+    }
+}
+
+void Shard::run() {
+    while (true) {
+        auto* connection = ready_.pop();
+        if (!connection) {
+            unique_lock lk(mtx_);
+            waiting_.store(true, memory_order_relaxed);
+            atomic_thread_fence(memory_order_seq_cst);
+            cv_.wait(lk, [this, &connection] {
+                connection = ready_.pop();
+                return connection || (stop_ && ready_.empty());
+            });
+            waiting_.store(false, memory_order_relaxed);
+            if (!connection) {
+                return;
+            }
+        }
+
+        if (connection->process(MAX_PACKETS_PER_TURN)) {
+            // the rest waits for the turn, reference is kept
+            ready_.push(connection);
+            continue;
+        }
+        connection->scheduled_.store(false);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (!connection->packets_.empty() && !connection->scheduled_.exchange(true)) {
+            // packet was enqueued after the last pop
+            ready_.push(connection);
+            continue;
+        }
+        connection->release();
+    }
+}
+
+// ConnectionPool
+ConnectionPool::ConnectionPool(std::size_t shards_count) {
+    if (shards_count == 0) {
+        shards_count = max(1u, thread::hardware_concurrency());
+    }
+    for (std::size_t i = 0; i < shards_count; ++i) {
+        shards_.push_back(make_unique<Shard>());
+    }
+}
+
+Connection* ConnectionPool::connect(std::size_t bulk_size, const SubscribeFunc& subscribe) {
+    auto& shard = *shards_[next_shard_.fetch_add(1, memory_order_relaxed) % shards_.size()];
+    auto* connection = new Connection(bulk_size, shard);
+    subscribe(*connection->getProcessor().getBulkMgr());
+    return connection;
+}
+
+void ConnectionPool::receive(Connection* connection, const char* data, std::size_t size) {
+    auto* packet = new Packet;
+    packet->data.assign(data, size);
+    connection->enqueue(packet);
+}
+
+void ConnectionPool::disconnect(Connection* connection) {
+    auto* packet = new Packet;
+    packet->last = true;
+    connection->enqueue(packet);
+    // the shard holds its own reference until the last packet is processed
+    connection->release();
+}
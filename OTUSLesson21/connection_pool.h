@@ -0,0 +1,115 @@
+#pragma once
+/**@file
+    @brief Connections processed by shard threads
+
+    Every connection is bound to one of the shard threads, receive only enqueues data
+*/
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "command_processor.h"
+#include "mpsc_queue.h"
+
+class Shard;
+
+/// Received data or disconnect mark
+struct Packet : MpscNode {
+    std::string data;
+    bool last = false;
+};
+
+/**
+ * @brief Connection context
+ *
+ * Handle of async library points to it. It's refcounted: reference of the handle
+ * is released by disconnect, shard holds a reference while the connection is scheduled.
+ * Commands are parsed and bulks are built only on the shard thread.
+ */
+class Connection : public MpscNode {
+public:
+    Connection(std::size_t bulk_size, Shard& shard)
+        : processor_(bulk_size), shard_(shard) {}
+
+    void addRef() {refs_.fetch_add(1, std::memory_order_relaxed);}
+    void release() {
+        if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    CommandProcessor& getProcessor() {return processor_;}
+
+    /// enqueues packet and schedules the connection on its shard (from any thread)
+    void enqueue(Packet* packet);
+
+private:
+    friend class Shard;
+    CommandProcessor processor_;
+    Shard& shard_;
+    MpscQueue<Packet> packets_;
+    std::atomic<bool> scheduled_{false};
+    std::atomic<int> refs_{1};
+    // methods
+    /// on shard thread, returns true if connection has more packets and must be scheduled again
+    bool process(std::size_t max_packets);
+    void close();
+};
+
+/**
+ * @brief Shard thread
+ *
+ * Processes scheduled connections in turn, a connection with many packets is returned
+ * to the end of the queue after max_packets (round robin between connections).
+ */
+class Shard {
+public:
+    Shard();
+    ~Shard();
+    Shard(const Shard&) = delete;
+    Shard& operator=(const Shard&) = delete;
+
+    /// takes a reference of the connection until it's processed
+    void schedule(Connection* connection);
+private:
+    static constexpr std::size_t MAX_PACKETS_PER_TURN = 64;
+
+    MpscQueue<Connection> ready_;
+    std::atomic<bool> waiting_{false};
+    bool stop_ = false;
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::thread worker_;
+    // methods
+    void run();
+};
+
+/**
+ * @brief Connections distributed between shards
+ *
+ * Connections are bound to shards round robin on connect.
+ * Pool destruction processes all received data and stops shards.
+ */
+class ConnectionPool {
+public:
+    using SubscribeFunc = std::function<void(BulkCmdManager&)>;
+
+    /// shards_count 0 -- number of hardware threads
+    explicit ConnectionPool(std::size_t shards_count = 0);
+
+    Connection* connect(std::size_t bulk_size, const SubscribeFunc& subscribe);
+    /// copies data, it's processed later on the shard thread
+    static void receive(Connection* connection, const char* data, std::size_t size);
+    /// received data is processed and the last bulk is flushed, then connection is destroyed
+    static void disconnect(Connection* connection);
+private:
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<std::size_t> next_shard_{0};
+};
@@ -0,0 +1,119 @@
+#include "console_writer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+using namespace std;
+
+BatchedFdWriter::BatchedFdWriter(int fd, Options options)
+    : fd_(fd), options_(options)
+{
+    if (options_.max_latency.count() > 0) {
+        flusher_ = thread(&BatchedFdWriter::flusher_loop, this);
+    }
+}
+
+BatchedFdWriter::~BatchedFdWriter() {
+    {
+        lock_guard lk(mtx_);
+        done_ = true;
+    }
+    cv_.notify_one();
+    if (flusher_.joinable()) {
+        flusher_.join();
+    }
+    flush();
+}
+
+void BatchedFdWriter::flush() {
+    // write lock keeps the order of batches
+    lock_guard wl(write_mtx_);
+    {
+        lock_guard lk(mtx_);
+        if (pending_bytes_ == 0) return;
+        swap(pending_, writing_);
+        pending_bytes_ = 0;
+    }
+    write_chunks();
+    lock_guard lk(mtx_);
+    for (auto& chunk : writing_) {
+        chunk.clear();
+        free_.push_back(std::move(chunk));
+    }
+    writing_.clear();
+}
+
+std::size_t BatchedFdWriter::writesCount() const {
+    lock_guard lk(mtx_);
+    return writes_count_;
+}
+
+std::string& BatchedFdWriter::current_chunk() {
+    if (pending_.empty() || pending_.back().size() >= CHUNK_SIZE) {
+        if (!free_.empty()) {
+            pending_.push_back(std::move(free_.back()));
+            free_.pop_back();
+        } else {
+            pending_.emplace_back();
+            pending_.back().reserve(CHUNK_SIZE);
+        }
+    }
+    return pending_.back();
+}
+
+void BatchedFdWriter::write_chunks() {
+    std::vector<iovec> iov;
+    iov.reserve(writing_.size());
+    for (auto& chunk : writing_) {
+        if (!chunk.empty()) {
+            iov.push_back(iovec{chunk.data(), chunk.size()});
+        }
+    }
+    auto* first = iov.data();
+    auto* last = iov.data() + iov.size();
+    std::size_t writes_count = 0;
+    while (first != last) {
+        auto count = static_cast<int>(min<std::ptrdiff_t>(last - first, IOV_MAX));
+        auto n = ::writev(fd_, first, count);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            // output is closed, nothing can be done
+            break;
+        }
+        ++writes_count;
+        // skip written buffers, partial write continues from the middle of the buffer
+        auto written = static_cast<std::size_t>(n);
+        while (first != last && written >= first->iov_len) {
+            written -= first->iov_len;
+            ++first;
+        }
+        if (first != last) {
+            first->iov_base = static_cast<char*>(first->iov_base) + written;
+            first->iov_len -= written;
+        }
+    }
+    lock_guard lk(mtx_);
+    writes_count_ += writes_count;
+}
+
+void BatchedFdWriter::flusher_loop() {
+    unique_lock lk(mtx_);
+    while (!done_) {
+        if (pending_bytes_ == 0) {
+            cv_.wait(lk, [this] {return done_ || pending_bytes_ > 0;});
+            continue;
+        }
+        auto deadline = oldest_ + options_.max_latency;
+        if (chrono::steady_clock::now() < deadline) {
+            cv_.wait_until(lk, deadline, [this] {return done_;});
+            continue;
+        }
+        lk.unlock();
+        flush();
+        lk.lock();
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+/**@file
+    @brief Batched console writer
+
+    Formatted bulks are accumulated in reused chunks and written with one writev
+*/
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Batched writer to file descriptor
+ *
+ * Records (e.g. formatted bulks) are formatted right into reused chunk buffers.
+ * Pending chunks are written with one writev when max_pending bytes are pending
+ * or the oldest pending record is max_latency old (background thread), max_latency 0 -- on every record.
+ * Record is never split between writes, records are written in the order of append.
+ * It can be shared by several producers.
+ */
+class BatchedFdWriter {
+public:
+    struct Options {
+        std::chrono::milliseconds max_latency{10};
+        std::size_t max_pending = 256 << 10;
+    };
+
+    explicit BatchedFdWriter(int fd, Options options);
+    ~BatchedFdWriter();
+    BatchedFdWriter(const BatchedFdWriter&) = delete;
+    BatchedFdWriter& operator=(const BatchedFdWriter&) = delete;
+
+    /// format(std::string& buffer) appends the record to buffer
+    template <typename F>
+    void append(F format) {
+        bool to_flush = false;
+        {
+            std::lock_guard lk(mtx_);
+            auto& chunk = current_chunk();
+            auto old_size = chunk.size();
+            format(chunk);
+            if (pending_bytes_ == 0) {
+                oldest_ = std::chrono::steady_clock::now();
+                cv_.notify_one();
+            }
+            pending_bytes_ += chunk.size() - old_size;
+            to_flush = options_.max_latency.count() == 0 || pending_bytes_ >= options_.max_pending;
+        }
+        if (to_flush) {
+            flush();
+        }
+    }
+
+    /// writes all pending records
+    void flush();
+
+    [[nodiscard]] std::size_t writesCount() const;
+private:
+    static constexpr std::size_t CHUNK_SIZE = 64 << 10;
+
+    int fd_ = -1;
+    Options options_;
+    std::vector<std::string> pending_;  ///< chunks, the last one is filled
+    std::vector<std::string> writing_;  ///< chunks under write (guarded by write_mtx_)
+    std::vector<std::string> free_;     ///< written chunks for reuse
+    std::size_t pending_bytes_ = 0;
+    std::size_t writes_count_ = 0;
+    std::chrono::steady_clock::time_point oldest_;
+    bool done_ = false;
+    mutable std::mutex mtx_;
+    std::mutex write_mtx_;
+    std::condition_variable cv_;
+    std::thread flusher_;
+    // methods
+    std::string& current_chunk();
+    void write_chunks();
+    void flusher_loop();
+};
+using FdWriterHolder = std::shared_ptr<BatchedFdWriter>;
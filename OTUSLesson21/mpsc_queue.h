@@ -0,0 +1,74 @@
+#pragma once
+/**@file
+    @brief Intrusive lock-free queue
+
+    Unbounded queue of many producers and one consumer (D. Vyukov's algorithm)
+*/
+
+#include <atomic>
+
+/// Base of queue elements
+struct MpscNode {
+    std::atomic<MpscNode*> next_{nullptr};
+};
+
+/**
+ * @brief Intrusive multi-producer single-consumer queue
+ *
+ * push is one atomic exchange (wait-free), pop is for the only consumer thread.
+ * Queue doesn't own elements. pop can return nullptr while a push is in the middle,
+ * empty() is false in this case, so consumer can reschedule itself.
+ */
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() = default;
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(T* node) {
+        push_node(node);
+    }
+
+    T* pop() {
+        MpscNode* tail = tail_;
+        MpscNode* next = tail->next_.load(std::memory_order_acquire);
+        if (tail == &stub_) {
+            if (!next) return nullptr;
+            tail_ = next;
+            tail = next;
+            next = next->next_.load(std::memory_order_acquire);
+        }
+        if (next) {
+            tail_ = next;
+            return static_cast<T*>(tail);
+        }
+        if (tail != head_.load(std::memory_order_acquire)) {
+            // producer is between exchange and link
+            return nullptr;
+        }
+        push_node(&stub_);
+        next = tail->next_.load(std::memory_order_acquire);
+        if (next) {
+            tail_ = next;
+            return static_cast<T*>(tail);
+        }
+        return nullptr;
+    }
+
+    /// consumer side check, pushed but not popped nodes make it false
+    [[nodiscard]] bool empty() const {
+        return tail_ == &stub_ && head_.load(std::memory_order_acquire) == &stub_;
+    }
+
+private:
+    MpscNode stub_;
+    std::atomic<MpscNode*> head_{&stub_};   ///< the last pushed node
+    MpscNode* tail_ = &stub_;               ///< the next node to pop
+
+    void push_node(MpscNode* node) {
+        node->next_.store(nullptr, std::memory_order_relaxed);
+        auto* prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next_.store(node, std::memory_order_release);
+    }
+};
@@ -0,0 +1,86 @@
+#include "observer_pool.h"
+
+#include "command_handler.h"
+
+using namespace std;
+
+// ObserverPool
+ObserverPool::ObserverPool(std::size_t threads_count) {
+    for (std::size_t i = 0; i < threads_count; ++i) {
+        workers_.emplace_back(&ObserverPool::run, this);
+    }
+}
+
+ObserverPool::~ObserverPool() {
+    {
+        lock_guard lk(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+ObserverPoolHolder ObserverPool::logPool() {
+    // managers hold the pool, it outlives the static reference
+    static auto pool = make_shared<ObserverPool>(1);
+    return pool;
+}
+
+ObserverPoolHolder ObserverPool::filePool() {
+    static auto pool = make_shared<ObserverPool>(FILE_THREADS_NUM);
+    return pool;
+}
+
+void ObserverPool::run() {
+    unique_lock lk(mtx_);
+    while (true) {
+        cv_.wait(lk, [this] {return stop_ || !ready_.empty();});
+        if (ready_.empty()) {
+            return;
+        }
+        auto* queue = ready_.front();
+        ready_.pop_front();
+        // queue is scheduled, so no other thread takes it: bulks of the connection are in order
+        for (std::size_t i = 0; i < MAX_BULKS_PER_TURN && queue->next_ < queue->bulks_.size(); ++i) {
+            {
+                auto item = std::move(queue->bulks_[queue->next_++]);
+                lk.unlock();
+                item.first->update(std::move(item.second));
+            }
+            lk.lock();
+        }
+        if (queue->next_ < queue->bulks_.size()) {
+            ready_.push_back(queue);
+            continue;
+        }
+        queue->bulks_.clear();
+        queue->next_ = 0;
+        queue->scheduled_ = false;
+        idle_cv_.notify_all();
+    }
+}
+
+// ObserverQueue
+ObserverQueue::~ObserverQueue() {
+    wait();
+}
+
+void ObserverQueue::post(std::shared_ptr<IObserver> observer, std::shared_ptr<const BulkCmd> bulk) {
+    {
+        lock_guard lk(pool_->mtx_);
+        bulks_.emplace_back(std::move(observer), std::move(bulk));
+        if (scheduled_) {
+            return;
+        }
+        scheduled_ = true;
+        pool_->ready_.push_back(this);
+    }
+    pool_->cv_.notify_one();
+}
+
+void ObserverQueue::wait() {
+    unique_lock lk(pool_->mtx_);
+    pool_->idle_cv_.wait(lk, [this] {return !scheduled_;});
+}
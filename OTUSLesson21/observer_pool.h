@@ -0,0 +1,84 @@
+#pragma once
+/**@file
+    @brief Observer pools shared by all bulk managers
+
+    Bulks are passed to observers on threads of process-wide pools instead of threads of every manager
+*/
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class IObserver;
+class BulkCmd;
+class ObserverQueue;
+
+class ObserverPool;
+using ObserverPoolHolder = std::shared_ptr<ObserverPool>;
+
+/**
+ * @brief Fixed number of threads serving observer queues
+ *
+ * Ready queues are served in turn: a queue with many bulks is returned to the end
+ * after MAX_BULKS_PER_TURN bulks (round robin between connections).
+ * Pool destruction processes all posted bulks.
+ */
+class ObserverPool {
+public:
+    explicit ObserverPool(std::size_t threads_count);
+    ~ObserverPool();
+    ObserverPool(const ObserverPool&) = delete;
+    ObserverPool& operator=(const ObserverPool&) = delete;
+
+    /// process-wide pool of console output, one thread for all connections
+    static ObserverPoolHolder logPool();
+    /// process-wide pool of file output
+    static ObserverPoolHolder filePool();
+
+    [[nodiscard]] std::size_t threadsCount() const {return workers_.size();}
+private:
+    friend class ObserverQueue;
+    static constexpr std::size_t FILE_THREADS_NUM = 2;
+    static constexpr std::size_t MAX_BULKS_PER_TURN = 16;
+
+    std::mutex mtx_;                    ///< guards the pool and all its queues
+    std::condition_variable cv_;        ///< a queue is ready or stop
+    std::condition_variable idle_cv_;   ///< a queue has no more bulks
+    std::deque<ObserverQueue*> ready_;
+    bool stop_ = false;
+    std::vector<std::thread> workers_;
+    // methods
+    void run();
+};
+
+/**
+ * @brief Serial notifications of one connection
+ *
+ * Bulks are passed to observers in the order of post, one at a time, on a thread of the pool.
+ * Destructor waits for the posted bulks.
+ */
+class ObserverQueue {
+public:
+    explicit ObserverQueue(ObserverPoolHolder pool)
+        : pool_(std::move(pool)) {}
+    ~ObserverQueue();
+    ObserverQueue(const ObserverQueue&) = delete;
+    ObserverQueue& operator=(const ObserverQueue&) = delete;
+
+    void post(std::shared_ptr<IObserver> observer, std::shared_ptr<const BulkCmd> bulk);
+    /// waits until all posted bulks are processed
+    void wait();
+private:
+    friend class ObserverPool;
+    using Item = std::pair<std::shared_ptr<IObserver>, std::shared_ptr<const BulkCmd>>;
+
+    ObserverPoolHolder pool_;
+    std::vector<Item> bulks_;   ///< not processed from next_, guarded by the pool mutex
+    std::size_t next_ = 0;
+    bool scheduled_ = false;    ///< queue is in the ready list or under processing
+};
@@ -1,13 +1,22 @@
 #define BOOST_TEST_MODULE async_test_module
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
 #include <sstream>
 #include <chrono>
+#include <cstring>
+#include <future>
+#include <mutex>
+
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "bulk.h"
 #include "command_reader.h"
 #include "command_handler.h"
 #include "command_processor.h"
+#include "connection_pool.h"
+#include "observer_pool.h"
 
 using namespace std;
 using namespace std::chrono_literals;
@@ -89,6 +98,97 @@ BOOST_AUTO_TEST_SUITE(first_bulk_test_suite)
 
 BOOST_AUTO_TEST_SUITE_END()
 
+BOOST_AUTO_TEST_SUITE(bulk_cmd_test_suite)
+
+    BOOST_AUTO_TEST_CASE(test_arena) {
+        BulkCmd bulk;
+        BOOST_CHECK(bulk.empty());
+        bulk.add("cmd1");
+        bulk.add("");
+        bulk.add("cmd3");
+        BOOST_CHECK(bulk.size() == 3u);
+        BOOST_CHECK(bulk[0] == "cmd1");
+        BOOST_CHECK(bulk[1].empty());
+        BOOST_CHECK(bulk[2] == "cmd3");
+        BOOST_CHECK(bulk.text() == "cmd1\n\ncmd3\n");
+        vector<string_view> cmds(bulk.begin(), bulk.end());
+        BOOST_CHECK(cmds == vector<string_view>({"cmd1", "", "cmd3"}));
+
+        // copy for observers doesn't depend on the reused buffer
+        BulkCmd copy(bulk);
+        bulk.clear();
+        bulk.add("other");
+        BOOST_CHECK(bulk.size() == 1u);
+        BOOST_CHECK(copy[2] == "cmd3");
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(console_writer_test_suite)
+
+    /// reads all available data from non-blocking fd
+    string read_available(int fd) {
+        string res;
+        char buf[4096];
+        ssize_t n = 0;
+        while ((n = ::read(fd, buf, sizeof(buf))) > 0) {
+            res.append(buf, static_cast<size_t>(n));
+        }
+        return res;
+    }
+
+    BulkCmdHolder make_bulk(std::initializer_list<string_view> cmds) {
+        auto bulk = make_shared<BulkCmd>();
+        for (auto cmd : cmds) {
+            bulk->add(cmd);
+        }
+        return bulk;
+    }
+
+    BOOST_AUTO_TEST_CASE(test_coalesced_writes) {
+        int fds[2];
+        BOOST_REQUIRE(::pipe2(fds, O_NONBLOCK) == 0);
+        {
+            auto writer = make_shared<BatchedFdWriter>(fds[1], BatchedFdWriter::Options{1h, 1 << 20});
+            CmdConsoleHandler handler(writer);
+            handler.update(make_bulk({"1", "2", "3"}));
+            handler.update(make_bulk({"4"}));
+            handler.update(make_bulk({"5", "6"}));
+            BOOST_CHECK(read_available(fds[0]).empty());
+            writer->flush();
+            BOOST_CHECK(writer->writesCount() == 1u);
+            BOOST_CHECK(read_available(fds[0]) == "bulk: 1, 2, 3\nbulk: 4\nbulk: 5, 6\n");
+
+            // size threshold
+            writer = make_shared<BatchedFdWriter>(fds[1], BatchedFdWriter::Options{1h, 10});
+            CmdConsoleHandler small_handler(writer);
+            small_handler.update(make_bulk({"cmd1"}));
+            BOOST_CHECK(read_available(fds[0]) == "bulk: cmd1\n");
+        }
+        ::close(fds[0]);
+        ::close(fds[1]);
+    }
+
+    BOOST_AUTO_TEST_CASE(test_latency_bound) {
+        int fds[2];
+        BOOST_REQUIRE(::pipe2(fds, O_NONBLOCK) == 0);
+        {
+            auto writer = make_shared<BatchedFdWriter>(fds[1], BatchedFdWriter::Options{10ms, 1 << 20});
+            CmdConsoleHandler handler(writer);
+            handler.update(make_bulk({"1", "2"}));
+            string res;
+            for (int i = 0; i < 500 && res.empty(); ++i) {
+                std::this_thread::sleep_for(10ms);
+                res = read_available(fds[0]);
+            }
+            BOOST_CHECK(res == "bulk: 1, 2\n");
+        }
+        ::close(fds[0]);
+        ::close(fds[1]);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
+
 BOOST_AUTO_TEST_SUITE(stream_cmd_reader_test_suite)
 
     BOOST_AUTO_TEST_CASE(test_Base) {
@@ -153,51 +253,92 @@ BOOST_AUTO_TEST_SUITE(stream_cmd_reader_test_suite)
 
 BOOST_AUTO_TEST_SUITE_END()
 
-BOOST_AUTO_TEST_SUITE(queue_cmd_reader_test_suite)
+BOOST_AUTO_TEST_SUITE(chunk_cmd_reader_test_suite)
 
-    BOOST_AUTO_TEST_CASE(test_Base) {
-        {
-            deque<string> in {"cmd1\n"};
-            QueueReader commandReader(in);
-            auto cmd = commandReader.read_next_cmd();
-            BOOST_CHECK(cmd.cmd_type == CommandType::Base);
-            BOOST_CHECK(cmd.data == "cmd1");
-        }
-        {
-            deque<string> in {"cmd1 cmd2\n"};
-            QueueReader commandReader(in);
-            auto cmd = commandReader.read_next_cmd();
-            BOOST_CHECK(cmd.cmd_type == CommandType::Base);
-            BOOST_CHECK(cmd.data == "cmd1 cmd2");
-        }
-        {
-            deque<string> in {"\n"};
-            QueueReader commandReader(in);
-            auto cmd = commandReader.read_next_cmd();
-            BOOST_CHECK(cmd.cmd_type == CommandType::Base);
-            BOOST_CHECK(cmd.data.empty());
+    /// reads all complete commands of the chunk
+    vector<string> read_all(ChunkCmdReader& commandReader, string_view chunk) {
+        commandReader.feed(chunk.data(), chunk.size());
+        vector<string> res;
+        while (commandReader.hasCmd()) {
+            res.emplace_back(commandReader.read_next_cmd().data);
         }
-        {
-            deque<string> in {"cmd{\n"};
-            QueueReader commandReader(in);
-            auto cmd = commandReader.read_next_cmd();
-            BOOST_CHECK(cmd.cmd_type == CommandType::Base);
-            BOOST_CHECK(cmd.data == "cmd{");
-        }
-        {
-            deque<string> in {"cmd}\n"};
-            QueueReader commandReader(in);
+        return res;
+    }
+
+    BOOST_AUTO_TEST_CASE(test_Base) {
+        ChunkCmdReader commandReader;
+        for (auto [line, data] : {pair{"cmd1\n", "cmd1"}, pair{"cmd1 cmd2\n", "cmd1 cmd2"}, pair{"\n", ""},
+                                  pair{"cmd{\n", "cmd{"}, pair{"cmd}\n", "cmd}"}}) {
+            commandReader.feed(line, strlen(line));
             auto cmd = commandReader.read_next_cmd();
             BOOST_CHECK(cmd.cmd_type == CommandType::Base);
-            BOOST_CHECK(cmd.data == "cmd}");
+            BOOST_CHECK(cmd.data == data);
         }
+        string chunk = "cmd1\ncmd2\n";
+        commandReader.feed(chunk.data(), chunk.size());
+        auto cmd = commandReader.read_next_cmd();
+        BOOST_CHECK(cmd.cmd_type == CommandType::Base);
+        BOOST_CHECK(cmd.data == "cmd1");
+    }
+
+    BOOST_AUTO_TEST_CASE(test_views) {
+        string chunk = "cmd1\n{\n\ncmd2\n";
+        ChunkCmdReader commandReader;
+        commandReader.feed(chunk.data(), chunk.size());
+        BOOST_REQUIRE(commandReader.hasCmd());
+        auto cmd = commandReader.read_next_cmd();
+        BOOST_CHECK(cmd.cmd_type == CommandType::Base);
+        BOOST_CHECK(cmd.data == "cmd1");
+        // not copied
+        BOOST_CHECK(cmd.data.data() == chunk.data());
+        BOOST_CHECK(commandReader.read_next_cmd().cmd_type == CommandType::StartCustomBulk);
+        cmd = commandReader.read_next_cmd();
+        BOOST_CHECK(cmd.cmd_type == CommandType::Base);
+        BOOST_CHECK(cmd.data.empty());
+        BOOST_CHECK(commandReader.read_next_cmd().data == "cmd2");
+        BOOST_CHECK(!commandReader.hasCmd());
+        BOOST_CHECK(commandReader.isCmdComplete());
+    }
+
+    BOOST_AUTO_TEST_CASE(test_split_lines) {
+        ChunkCmdReader commandReader;
+        BOOST_CHECK(read_all(commandReader, "cm").empty());
+        BOOST_CHECK(!commandReader.isCmdComplete());
+        BOOST_CHECK(read_all(commandReader, "d").empty());
+        // the chunk memory can be reused
+        string chunk = "1\ncmd2\ncmd";
+        BOOST_CHECK(read_all(commandReader, chunk) == vector<string>({"cmd1", "cmd2"}));
+        chunk = "xxxxx";
+        BOOST_CHECK(read_all(commandReader, "3\ncmd4") == vector<string>({"cmd3"}));
+        BOOST_CHECK(read_all(commandReader, "\n") == vector<string>({"cmd4"}));
+        BOOST_CHECK(commandReader.isCmdComplete());
+    }
+
+    BOOST_AUTO_TEST_CASE(test_partial_at_end) {
+        ChunkCmdReader commandReader;
+        BOOST_CHECK(read_all(commandReader, "cmd1\ncmd") == vector<string>({"cmd1"}));
+        BOOST_REQUIRE(!commandReader.isCmdComplete());
+        auto cmd = commandReader.read_next_cmd();
+        BOOST_CHECK(cmd.cmd_type == CommandType::Base);
+        BOOST_CHECK(cmd.data == "cmd");
+        BOOST_CHECK(commandReader.isCmdComplete());
+        BOOST_CHECK(commandReader.read_next_cmd().cmd_type == CommandType::Terminator);
+    }
+
+    BOOST_AUTO_TEST_CASE(test_processor) {
+        constexpr int N = 5;
+        stringstream out;
         {
-            deque<string> in {"cmd1\n", "cmd2\n"};
-            QueueReader commandReader(in);
-            auto cmd = commandReader.read_next_cmd();
-            BOOST_CHECK(cmd.cmd_type == CommandType::Base);
-            BOOST_CHECK(cmd.data == "cmd1");
+            CommandProcessor processor(N);
+            createObserverAndSubscribe<CmdStreamHandler>(processor.getBulkMgr().get(), out);
+            for (string_view packet : {"1", "\n2\n3\n4\n5\n6\n{\na\n", "b\nc\nd\n}\n89\n"}) {
+                string data(packet);
+                processor.feed(data.data(), data.size());
+                process_all_commands(processor.getcmdReader(), *processor.getBulkMgr());
+            }
+            processor.getBulkMgr()->add_cmd(Command{CommandType::Terminator});
         }
+        BOOST_CHECK(out.str() == "bulk: 1, 2, 3, 4, 5\nbulk: 6\nbulk: a, b, c, d\nbulk: 89\n");
     }
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -206,11 +347,12 @@ BOOST_AUTO_TEST_SUITE(async_bulk_test_suite)
 
     BOOST_AUTO_TEST_CASE(test_1) {
         constexpr int N = 3;
-        deque<string> in {"1\n", "2\n", "3\n", "4\n", "5\n"};
+        string in = "1\n2\n3\n4\n5\n";
         stringstream out;
         {
             auto bulkMgr = make_unique<BulkCmdManager>(N);
-            auto commandReader = make_unique<QueueReader>(in);
+            auto commandReader = make_unique<ChunkCmdReader>();
+            commandReader->feed(in.data(), in.size());
 
             createObserverAndSubscribe<CmdStreamHandler>(bulkMgr.get(), out);
             process_all_commands(*commandReader, *bulkMgr);
@@ -222,11 +364,12 @@ BOOST_AUTO_TEST_SUITE(async_bulk_test_suite)
 
     BOOST_AUTO_TEST_CASE(test_2) {
         constexpr int N = 3;
-        deque<string> in {"1\n", "2\n", "{\n", "3\n", "4\n", "5\n", "6\n", "7\n", "}\n"};
+        string in = "1\n2\n{\n3\n4\n5\n6\n7\n}\n";
         stringstream out;
         {
             auto bulkMgr = make_unique<BulkCmdManager>(N);
-            auto commandReader = make_unique<QueueReader>(in);
+            auto commandReader = make_unique<ChunkCmdReader>();
+            commandReader->feed(in.data(), in.size());
             createObserverAndSubscribe<CmdStreamHandler>(bulkMgr.get(), out);
 
             // start commands cycle
@@ -239,11 +382,12 @@ BOOST_AUTO_TEST_SUITE(async_bulk_test_suite)
 
     BOOST_AUTO_TEST_CASE(test_3) {
         constexpr int N = 3;
-        deque<string> in {"{\n", "1\n", "2\n", "{\n", "3\n", "4\n", "}\n", "5\n", "6\n", "}\n"};
+        string in = "{\n1\n2\n{\n3\n4\n}\n5\n6\n}\n";
         stringstream out;
         {
             auto bulkMgr = make_unique<BulkCmdManager>(N);
-            auto commandReader = make_unique<QueueReader>(in);
+            auto commandReader = make_unique<ChunkCmdReader>();
+            commandReader->feed(in.data(), in.size());
             createObserverAndSubscribe<CmdStreamHandler>(bulkMgr.get(), out);
 
             // start commands cycle
@@ -256,11 +400,12 @@ BOOST_AUTO_TEST_SUITE(async_bulk_test_suite)
 
     BOOST_AUTO_TEST_CASE(test_4) {
         constexpr int N = 3;
-        deque<string> in {"1\n", "2\n", "3\n", "{\n", "4\n", "5\n", "6\n", "7\n"};
+        string in = "1\n2\n3\n{\n4\n5\n6\n7\n";
         stringstream out;
         {
             auto bulkMgr = make_unique<BulkCmdManager>(N);
-            auto commandReader = make_unique<QueueReader>(in);
+            auto commandReader = make_unique<ChunkCmdReader>();
+            commandReader->feed(in.data(), in.size());
             createObserverAndSubscribe<CmdStreamHandler>(bulkMgr.get(), out);
 
             // start commands cycle
@@ -276,23 +421,18 @@ BOOST_AUTO_TEST_SUITE(async_bulk_test_suite)
         constexpr int N = 5;
 
         // first receive
-        deque<string> in {"1"};
+        string in = "1";
         stringstream out;
-        auto commandReader = make_unique<QueueReader>(in);
+        auto commandReader = make_unique<ChunkCmdReader>();
+        commandReader->feed(in.data(), in.size());
         auto bulkMgr = make_unique<BulkCmdManager>(N);
         createObserverAndSubscribe<CmdStreamHandler>(bulkMgr.get(), out);
         process_all_commands(*commandReader, *bulkMgr);
         BOOST_CHECK(out.str().empty());
 
         // second receive
-        in.back() += "\n";
-        in.emplace_back("2\n");
-        in.emplace_back("3\n");
-        in.emplace_back("4\n");
-        in.emplace_back("5\n");
-        in.emplace_back("6\n");
-        in.emplace_back("{\n");
-        in.emplace_back("a\n");
+        string in2 = "\n2\n3\n4\n5\n6\n{\na\n";
+        commandReader->feed(in2.data(), in2.size());
         process_all_commands(*commandReader, *bulkMgr);
         std::this_thread::sleep_for(100ms);
         string res = "bulk: 1, 2, 3, 4, 5\nbulk: 6\n";
@@ -300,11 +440,8 @@ BOOST_AUTO_TEST_SUITE(async_bulk_test_suite)
         out.str("");
 
         //third recieve
-        in.emplace_back("b\n");
-        in.emplace_back("c\n");
-        in.emplace_back("d\n");
-        in.emplace_back("}\n");
-        in.emplace_back("89\n");
+        string in3 = "b\nc\nd\n}\n89\n";
+        commandReader->feed(in3.data(), in3.size());
         process_all_commands(*commandReader, *bulkMgr);
         bulkMgr->add_cmd(Command{CommandType::Terminator});
         std::this_thread::sleep_for(100ms);
@@ -315,13 +452,14 @@ BOOST_AUTO_TEST_SUITE(async_bulk_test_suite)
     BOOST_AUTO_TEST_CASE(test_6_terminate_wo_end) {
         constexpr int N = 5;
 
-        deque<string> in {"1\n", "2\n", "3\n", "4"};
+        string in = "1\n2\n3\n4";
         stringstream out;
         auto bulkMgr = make_unique<BulkCmdManager>(N);
-        auto commandReader = make_unique<QueueReader>(in);
+        auto commandReader = make_unique<ChunkCmdReader>();
+        commandReader->feed(in.data(), in.size());
         createObserverAndSubscribe<CmdStreamHandler>(bulkMgr.get(), out);
         process_all_commands(*commandReader, *bulkMgr);
-        if (!in.empty()) {
+        if (!commandReader->isCmdComplete()) {
             auto cmd = commandReader->read_next_cmd();
             bulkMgr->add_cmd(move(cmd));
         }
@@ -334,21 +472,175 @@ BOOST_AUTO_TEST_SUITE(async_bulk_test_suite)
     BOOST_AUTO_TEST_CASE(test_7_caught_in_the_middle) {
         constexpr int N = 3;
 
-        deque<string> in {"cmd1\n", "cmd"};
+        string in = "cmd1\ncmd";
         stringstream out;
         auto bulkMgr = make_unique<BulkCmdManager>(N);
-        auto commandReader = make_unique<QueueReader>(in);
+        auto commandReader = make_unique<ChunkCmdReader>();
+        commandReader->feed(in.data(), in.size());
         createObserverAndSubscribe<CmdStreamHandler>(bulkMgr.get(), out);
         process_all_commands(*commandReader, *bulkMgr);
         std::this_thread::sleep_for(100ms);
         BOOST_CHECK(out.str().empty());
 
-        in.back() += "2\n";
-        in.emplace_back("cmd3\n");
+        string in2 = "2\ncmd3\n";
+        commandReader->feed(in2.data(), in2.size());
         process_all_commands(*commandReader, *bulkMgr);
         std::this_thread::sleep_for(100ms);
         string res = "bulk: cmd1, cmd2, cmd3\n";
         BOOST_CHECK(out.str() == res);
     }
 
-BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(connection_pool_test_suite)
+
+    BOOST_AUTO_TEST_CASE(test_connections) {
+        constexpr std::size_t N = 3;
+        constexpr std::size_t CONNECTIONS = 8;
+        vector<stringstream> outs(CONNECTIONS);
+        {
+            ConnectionPool pool(2);
+            vector<thread> producers;
+            for (std::size_t i = 0; i < CONNECTIONS; ++i) {
+                auto* connection = pool.connect(N, [&out = outs[i]](BulkCmdManager& bulkMgr) {
+                    createObserverAndSubscribe<CmdStreamHandler>(&bulkMgr, out);
+                });
+                // calls of one connection are from the same thread
+                producers.emplace_back([connection] {
+                    for (string_view packet : {"1\n2", "\n3\n4\n", "{\n5\n}\n6"}) {
+                        ConnectionPool::receive(connection, packet.data(), packet.size());
+                    }
+                    ConnectionPool::disconnect(connection);
+                });
+            }
+            for (auto& producer : producers) {
+                producer.join();
+            }
+        }
+        for (const auto& out : outs) {
+            BOOST_CHECK(out.str() == "bulk: 1, 2, 3\nbulk: 4\nbulk: 5\nbulk: 6\n");
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(test_many_packets) {
+        // more packets than a connection processes per turn
+        constexpr std::size_t PACKETS = 1000;
+        stringstream out1;
+        stringstream out2;
+        {
+            ConnectionPool pool(1);
+            auto* c1 = pool.connect(10, [&out1](BulkCmdManager& bulkMgr) {
+                createObserverAndSubscribe<CmdStreamHandler>(&bulkMgr, out1);
+            });
+            auto* c2 = pool.connect(1000, [&out2](BulkCmdManager& bulkMgr) {
+                createObserverAndSubscribe<CmdStreamHandler>(&bulkMgr, out2);
+            });
+            for (std::size_t i = 0; i < PACKETS; ++i) {
+                auto packet = to_string(i) + "\n";
+                ConnectionPool::receive(c1, packet.data(), packet.size());
+                ConnectionPool::receive(c2, packet.data(), packet.size());
+            }
+            ConnectionPool::disconnect(c1);
+            ConnectionPool::disconnect(c2);
+        }
+        string res1;
+        string res2 = "bulk: ";
+        for (std::size_t i = 0; i < PACKETS; ++i) {
+            res1 += (i % 10 == 0 ? "bulk: " : ", ") + to_string(i) + (i % 10 == 9 ? "\n" : "");
+            res2 += (i == 0 ? "" : ", ") + to_string(i);
+        }
+        res2 += "\n";
+        BOOST_CHECK(out1.str() == res1);
+        BOOST_CHECK(out2.str() == res2);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(observer_pool_test_suite)
+
+    /// records "name:first command" of bulks, can hold the pool thread until open
+    class RecordingHandler : public IObserver {
+    public:
+        RecordingHandler(string name, vector<string>& records, mutex& mtx, shared_future<void> gate = {})
+            : name_(std::move(name)), records_(records), mtx_(mtx), gate_(std::move(gate)) {}
+
+        void update(BulkCmdHolder bulk_holder) override {
+            if (gate_.valid()) {
+                gate_.wait();
+            }
+            lock_guard lk(mtx_);
+            records_.push_back(name_ + ":" + string((*bulk_holder)[0]));
+        }
+    private:
+        string name_;
+        vector<string>& records_;
+        mutex& mtx_;
+        shared_future<void> gate_;
+    };
+
+    BulkCmdHolder make_bulk(const string& cmd) {
+        auto bulk = make_shared<BulkCmd>();
+        bulk->add(cmd);
+        return bulk;
+    }
+
+    BOOST_AUTO_TEST_CASE(test_order) {
+        constexpr std::size_t QUEUES = 10;
+        constexpr std::size_t BULKS = 100;
+        vector<vector<string>> records(QUEUES);
+        vector<mutex> mutexes(QUEUES);
+        {
+            auto pool = make_shared<ObserverPool>(3);
+            vector<unique_ptr<ObserverQueue>> queues;
+            vector<ObserverHolder> observers;
+            for (std::size_t q = 0; q < QUEUES; ++q) {
+                queues.push_back(make_unique<ObserverQueue>(pool));
+                observers.push_back(make_shared<RecordingHandler>("q", records[q], mutexes[q]));
+            }
+            for (std::size_t i = 0; i < BULKS; ++i) {
+                for (std::size_t q = 0; q < QUEUES; ++q) {
+                    queues[q]->post(observers[q], make_bulk(to_string(i)));
+                }
+            }
+            // queue destruction waits for its bulks
+        }
+        vector<string> expected;
+        for (std::size_t i = 0; i < BULKS; ++i) {
+            expected.push_back("q:" + to_string(i));
+        }
+        for (const auto& queue_records : records) {
+            BOOST_CHECK(queue_records == expected);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(test_round_robin) {
+        vector<string> records;
+        mutex mtx;
+        promise<void> gate;
+        auto pool = make_shared<ObserverPool>(1);
+        ObserverQueue gate_queue(pool);
+        ObserverQueue busy_queue(pool);
+        ObserverQueue other_queue(pool);
+        auto gate_observer = make_shared<RecordingHandler>("gate", records, mtx, gate.get_future().share());
+        auto busy_observer = make_shared<RecordingHandler>("busy", records, mtx);
+        auto other_observer = make_shared<RecordingHandler>("other", records, mtx);
+
+        // the only pool thread is held until all bulks are posted
+        gate_queue.post(gate_observer, make_bulk("0"));
+        for (std::size_t i = 0; i < 100; ++i) {
+            busy_queue.post(busy_observer, make_bulk(to_string(i)));
+        }
+        other_queue.post(other_observer, make_bulk("0"));
+        gate.set_value();
+        busy_queue.wait();
+        other_queue.wait();
+
+        BOOST_REQUIRE(records.size() == 102u);
+        BOOST_CHECK(records[0] == "gate:0");
+        // the other connection doesn't wait for all bulks of the busy one
+        auto other_pos = find(records.begin(), records.end(), "other:0") - records.begin();
+        BOOST_CHECK(other_pos < 50);
+        BOOST_CHECK(records.back() == "busy:99");
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,5 +1,7 @@
 #include "async.h"
+#include "async_subscribe.h"
 
+#include <atomic>
 #include <utility>
 #include <mutex>
 
@@ -14,10 +16,19 @@ namespace async {
 
 static ThreadSafeUnorderedMap<unique_ptr<CommandProcessor>> bulkmgrs;
 
+static SubscribeFunc& subscribe_func() {
+    static SubscribeFunc subscribe = [](BulkCmdManager& bulkMgr) {
+        createObserverAndSubscribe<CmdStreamHandler>(&bulkMgr);
+        createObserverAndSubscribe<CmdFileHandler>(&bulkMgr);
+    };
+    return subscribe;
+}
+
+static atomic<chrono::milliseconds> max_latency_ms{chrono::milliseconds(0)};
+
 handle_t connect(std::size_t bulk_size) {
-    auto dataProcessor = make_unique<CommandProcessor>(bulk_size);
-    createObserverAndSubscribe<CmdStreamHandler>(dataProcessor->getBulkMgr().get());
-    createObserverAndSubscribe<CmdFileHandler>(dataProcessor->getBulkMgr().get());
+    auto dataProcessor = make_unique<CommandProcessor>(bulk_size, max_latency_ms.load());
+    subscribe_func()(*dataProcessor->getBulkMgr());
     return reinterpret_cast<void*>(
         bulkmgrs.push(move(dataProcessor))
     );
@@ -31,7 +42,8 @@ void receive(handle_t handle, const char *data, std::size_t size) {
         auto &bulkMgr = dataProcessor.getBulkMgr();
         auto &mtx = dataProcessor.getMutex();
         lock_guard<mutex> lk(mtx);
-        dataProcessor.pushToBuffer(data, size);
+        // data is parsed in place, only commands and a partial line are copied
+        dataProcessor.feed(data, size);
         process_all_commands(cmdReader, *bulkMgr);
     }
 }
@@ -39,24 +51,32 @@ void receive(handle_t handle, const char *data, std::size_t size) {
 void disconnect(handle_t handle) {
     auto idx = reinterpret_cast<size_t>(handle);
     if (bulkmgrs.contains(idx)) {
-        auto &dataProcessor = *bulkmgrs[idx];
-        auto &buffer = dataProcessor.getBuffer();
-        auto &cmdReader = dataProcessor.getcmdReader();
-        auto &bulkMgr = dataProcessor.getBulkMgr();
-        auto &mtx = dataProcessor.getMutex();
         {
-            lock_guard<mutex> lk(mtx);
-            if (!buffer.empty()) {
+            auto &dataProcessor = *bulkmgrs[idx];
+            auto &cmdReader = dataProcessor.getcmdReader();
+            auto &bulkMgr = dataProcessor.getBulkMgr();
+            lock_guard<mutex> lk(dataProcessor.getMutex());
+            if (!cmdReader.isCmdComplete()) {
                 auto cmd = cmdReader.read_next_cmd();
                 bulkMgr->add_cmd(move(cmd));
             }
-            if (bulkmgrs.size() == 1) {
-                Command cmd{CommandType::Terminator};
-                bulkMgr->add_cmd(move(cmd));
-            }
         }
-        bulkmgrs.erase(idx);
+        // removal and the check are atomic: connections are closed in parallel,
+        // the last one flushes the common bulk after all others added their commands
+        auto [dataProcessor, rest] = bulkmgrs.extract(idx);
+        if (rest == 0) {
+            Command cmd{CommandType::Terminator};
+            dataProcessor->getBulkMgr()->add_cmd(move(cmd));
+        }
     }
 }
 
-}
\ No newline at end of file
+void set_subscribe(SubscribeFunc subscribe) {
+    subscribe_func() = move(subscribe);
+}
+
+void set_max_latency(std::chrono::milliseconds max_latency) {
+    max_latency_ms = max_latency;
+}
+
+}
@@ -1,6 +1,7 @@
 #include "async_server.h"
 
 #include <iostream>
+#include <thread>
 
 using namespace std;
 using boost::asio::ip::tcp;
@@ -13,12 +14,13 @@ void RequestHandler::start()
 void RequestHandler::do_read() {
     auto self(shared_from_this());
     socket_.async_read_some(
-            ba::buffer(data_),
+            ba::buffer(data_.data(), buffer_size_),
             [this, self](boost::system::error_code ec, std::size_t length)
             {
                 if (!ec)
                 {
                     async::receive(handle_, data_.data(), length);
+                    adapt_buffer(length);
                     do_read();
                 } else {
                     async::disconnect(handle_);
@@ -27,19 +29,73 @@ void RequestHandler::do_read() {
     );
 }
 
+void RequestHandler::adapt_buffer(std::size_t read_size) {
+    // full buffer means there is more data in the socket
+    if (read_size == buffer_size_ && buffer_size_ < MAX_BUFFER_SIZE) {
+        buffer_size_ *= 2;
+        small_reads_ = 0;
+        // memory is kept after shrink, so it's allocated once per size
+        if (data_.size() < buffer_size_) {
+            data_.resize(buffer_size_);
+        }
+    } else if (read_size < buffer_size_ / 4 && buffer_size_ > MIN_BUFFER_SIZE) {
+        // alternating traffic doesn't shrink and grow the buffer on every packet
+        if (++small_reads_ == SHRINK_AFTER_READS) {
+            buffer_size_ /= 2;
+            small_reads_ = 0;
+        }
+    } else {
+        small_reads_ = 0;
+    }
+}
+
+IoServicePool::IoServicePool(std::size_t size) {
+    if (size == 0) {
+        size = max(1u, thread::hardware_concurrency());
+    }
+    for (std::size_t i = 0; i < size; ++i) {
+        services_.push_back(make_unique<ba::io_service>());
+        // io_service without connections doesn't return from run
+        works_.emplace_back(*services_.back());
+    }
+}
+
+ba::io_service& IoServicePool::next() {
+    auto& service = *services_[next_];
+    next_ = (next_ + 1) % services_.size();
+    return service;
+}
+
+void IoServicePool::run() {
+    vector<thread> threads;
+    for (std::size_t i = 1; i < services_.size(); ++i) {
+        threads.emplace_back([&service = *services_[i]] {service.run();});
+    }
+    services_.front()->run();
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+void IoServicePool::stop() {
+    for (auto& service : services_) {
+        service->stop();
+    }
+}
+
 
 void BulkAsyncServer::do_accept() {
-    acceptor_.async_accept(socket_,
-            [this](boost::system::error_code ec)
+    // socket is bound to the next io_service, its handlers run in that thread
+    auto socket = make_shared<tcp::socket>(pool_.next());
+    acceptor_.async_accept(*socket,
+            [this, socket](boost::system::error_code ec)
             {
                 if (!ec)
                 {
-                    std::make_shared<RequestHandler>(std::move(socket_), bulk_size_)->start();
+                    std::make_shared<RequestHandler>(std::move(*socket), bulk_size_)->start();
                 }
 
                 do_accept();
             }
     );
 }
-
-
@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <algorithm>
+#include <vector>
 
 #include <boost/asio.hpp>
 
@@ -9,39 +10,78 @@
 
 namespace ba = boost::asio;
 
+/**
+ * @brief Connection of the client
+ *
+ * Receive buffer is adaptive: it grows while reads fill it and shrinks back after
+ * SHRINK_AFTER_READS small reads in a row. Only the used size shrinks, the memory is kept.
+ * Received data is passed to async library as is, library parses it in place.
+ */
 class RequestHandler : public std::enable_shared_from_this<RequestHandler> {
 public:
     explicit RequestHandler(ba::ip::tcp::socket socket, std::size_t bulk_size)
-        : socket_(std::move(socket)), handle_(async::connect(bulk_size))
-    {
-        std::fill(data_.begin(), data_.end(), 0);
-    }
+        : socket_(std::move(socket)), data_(MIN_BUFFER_SIZE), handle_(async::connect(bulk_size))
+    {}
 
     void start();
 
 private:
+    static constexpr std::size_t MIN_BUFFER_SIZE = 4 << 10;
+    static constexpr std::size_t MAX_BUFFER_SIZE = 256 << 10;
+    static constexpr std::size_t SHRINK_AFTER_READS = 8;
+
     ba::ip::tcp::socket socket_;
-    std::array<char, 1024> data_;
+    std::vector<char> data_;
+    std::size_t buffer_size_ = MIN_BUFFER_SIZE;   ///< used size of data_
+    std::size_t small_reads_ = 0;                  ///< reads under a quarter of the buffer in a row
     async::handle_t handle_;
 
     // methods
     void do_read();
+    void adapt_buffer(std::size_t read_size);
+};
+
+/**
+ * @brief io_service per thread
+ *
+ * Connections are distributed between io_services round robin, so handlers of
+ * a connection are executed by one thread and connections are processed in parallel.
+ */
+class IoServicePool {
+public:
+    /// size 0 -- number of hardware threads
+    explicit IoServicePool(std::size_t size);
+
+    ba::io_service& next();
+    /// runs io_services in threads (the first one in the calling thread) until stop
+    void run();
+    void stop();
+
+    [[nodiscard]] std::size_t size() const {return services_.size();}
+
+private:
+    std::vector<std::unique_ptr<ba::io_service>> services_;
+    std::vector<ba::io_service::work> works_;
+    std::size_t next_ = 0;
 };
 
 class BulkAsyncServer {
 public:
-    BulkAsyncServer(ba::io_service& io_service, const ba::ip::tcp::endpoint& endpoint,
+    BulkAsyncServer(IoServicePool& pool, const ba::ip::tcp::endpoint& endpoint,
                     std::size_t bulk_size)
-        : acceptor_(io_service, endpoint), socket_(io_service), bulk_size_(bulk_size)
+        : pool_(pool), acceptor_(pool.next(), endpoint), bulk_size_(bulk_size)
     {
         do_accept();
     }
 
+    /// actual endpoint, e.g. when the server is started on port 0
+    [[nodiscard]] ba::ip::tcp::endpoint endpoint() const {return acceptor_.local_endpoint();}
+
 private:
 
     void do_accept();
 
+    IoServicePool& pool_;
     boost::asio::ip::tcp::acceptor acceptor_;
-    ba::ip::tcp::socket socket_;
     std::size_t bulk_size_ = 0;
-};
\ No newline at end of file
+};
@@ -0,0 +1,23 @@
+#pragma once
+/**@file
+    @brief Observers and options of async library connections
+
+    By default bulks of every connection are written to console and files
+*/
+
+#include <chrono>
+#include <functional>
+
+class BulkCmdManager;
+
+namespace async {
+
+using SubscribeFunc = std::function<void(BulkCmdManager&)>;
+
+/// observers of connections created after the call (e.g. test or benchmark observer), it's set before the server is started
+void set_subscribe(SubscribeFunc subscribe);
+
+/// bulk is flushed when its oldest command is older than max_latency, 0 -- off (default); for connections created after the call
+void set_max_latency(std::chrono::milliseconds max_latency);
+
+}
@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "async_server.h"
+#include "async_subscribe.h"
+#include "bulk.h"
+#include "command_handler.h"
+
+using namespace std;
+namespace ba = boost::asio;
+using boost::asio::ip::tcp;
+using namespace std::chrono_literals;
+
+namespace {
+
+using Clock = chrono::steady_clock;
+
+std::int64_t now_ns() {
+    return chrono::duration_cast<chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+/// latencies from send to bulk flush, command is the time of its send
+class LatencyRecorder {
+public:
+    void add(const BulkCmd& bulk) {
+        auto now = now_ns();
+        lock_guard lk(mtx_);
+        for (const auto& cmd : bulk.getData()) {
+            latencies_.push_back(now - stoll(cmd.data));
+        }
+        last_flush_ = Clock::now();
+        count_ = latencies_.size();
+    }
+
+    [[nodiscard]] std::size_t count() const {return count_.load();}
+
+    std::vector<std::int64_t> latencies() {
+        lock_guard lk(mtx_);
+        return latencies_;
+    }
+
+    Clock::time_point lastFlush() {
+        lock_guard lk(mtx_);
+        return last_flush_;
+    }
+private:
+    std::mutex mtx_;
+    std::vector<std::int64_t> latencies_;
+    Clock::time_point last_flush_;
+    std::atomic<std::size_t> count_{0};
+};
+
+class LatencyObserver : public IObserver {
+public:
+    explicit LatencyObserver(LatencyRecorder& recorder)
+        : recorder_(recorder) {}
+
+    void update(BulkCmdHolder bulk_holder) override {
+        recorder_.add(*bulk_holder);
+    }
+private:
+    LatencyRecorder& recorder_;
+};
+
+enum class Mix {Plain, Nested, Partial};
+
+constexpr std::size_t PACKET_COMMANDS = 10;
+
+/// packet of PACKET_COMMANDS commands stamped with the send time
+string make_packet(Mix mix) {
+    auto stamp = to_string(now_ns()) + "\n";
+    string packet;
+    for (std::size_t i = 0; i < PACKET_COMMANDS; ++i) {
+        // nested: { c c c { c c } } c c c c c
+        if (mix == Mix::Nested && (i == 0 || i == 3)) {
+            packet += "{\n";
+        }
+        packet += stamp;
+        if (mix == Mix::Nested && i == 4) {
+            packet += "}\n}\n";
+        }
+    }
+    return packet;
+}
+
+/// value of /proc/self/status field in kB, e.g. "VmRSS" or "VmHWM"
+std::size_t proc_status(const string& key) {
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (line.compare(0, key.size() + 1, key + ":") == 0) {
+            return strtoull(line.c_str() + key.size() + 1, nullptr, 10);
+        }
+    }
+    return 0;
+}
+
+std::int64_t percentile(const std::vector<std::int64_t>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    auto idx = static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1));
+    return sorted[idx];
+}
+
+} // namespace
+
+// bench_bulk_server [connections] [commands] [bulk_size] [plain|nested|partial] [server_threads]
+// server and clients are in one process, result is one json line
+int main(int argc, char* argv[]) {
+    try
+    {
+        std::size_t connections_count = argc > 1 ? stoul(argv[1]) : 100;
+        std::size_t commands_count = argc > 2 ? stoul(argv[2]) : 1000;
+        std::size_t bulk_size = argc > 3 ? stoul(argv[3]) : 10;
+        string mix_name = argc > 4 ? argv[4] : "plain";
+        std::size_t server_threads = argc > 5 ? stoul(argv[5]) : 0;
+        Mix mix = mix_name == "nested" ? Mix::Nested : mix_name == "partial" ? Mix::Partial : Mix::Plain;
+        // every connection sends whole packets
+        std::size_t packets_count = max<std::size_t>(1, commands_count / PACKET_COMMANDS);
+        std::size_t total_commands = connections_count * packets_count * PACKET_COMMANDS;
+
+        LatencyRecorder recorder;
+        async::set_subscribe([&recorder](BulkCmdManager& bulkMgr) {
+            createObserverAndSubscribe<LatencyObserver>(&bulkMgr, recorder);
+        });
+        IoServicePool pool(server_threads);
+        BulkAsyncServer server(pool, tcp::endpoint(ba::ip::address_v4::loopback(), 0), bulk_size);
+        auto endpoint = server.endpoint();
+        thread server_thread([&pool] {pool.run();});
+
+        // every client thread sends packets to its connections in turn
+        std::size_t clients_count = min<std::size_t>(connections_count, 8);
+        auto start = Clock::now();
+        vector<thread> clients;
+        for (std::size_t c = 0; c < clients_count; ++c) {
+            clients.emplace_back([&, c] {
+                ba::io_service io;
+                vector<tcp::socket> sockets;
+                for (std::size_t i = c; i < connections_count; i += clients_count) {
+                    sockets.emplace_back(io);
+                    sockets.back().connect(endpoint);
+                    sockets.back().set_option(tcp::no_delay(true));
+                }
+                vector<string> tails(sockets.size());
+                for (std::size_t p = 0; p < packets_count; ++p) {
+                    for (std::size_t s = 0; s < sockets.size(); ++s) {
+                        auto packet = make_packet(mix);
+                        if (mix == Mix::Partial) {
+                            // every write ends in the middle of a line
+                            auto split = packet.size() / 2 + 1;
+                            auto data = tails[s] + packet.substr(0, split);
+                            tails[s] = packet.substr(split);
+                            packet = std::move(data);
+                        }
+                        ba::write(sockets[s], ba::buffer(packet));
+                    }
+                }
+                for (std::size_t s = 0; s < sockets.size(); ++s) {
+                    ba::write(sockets[s], ba::buffer(tails[s]));
+                    sockets[s].shutdown(tcp::socket::shutdown_send);
+                    sockets[s].close();
+                }
+            });
+        }
+        for (auto& client : clients) {
+            client.join();
+        }
+
+        auto deadline = Clock::now() + 120s;
+        while (recorder.count() < total_commands && Clock::now() < deadline) {
+            this_thread::sleep_for(1ms);
+        }
+        pool.stop();
+        server_thread.join();
+
+        auto latencies = recorder.latencies();
+        sort(latencies.begin(), latencies.end());
+        chrono::duration<double> elapsed = recorder.lastFlush() - start;
+        auto us = [&latencies](double p) {return static_cast<double>(percentile(latencies, p)) / 1000.0;};
+
+        cout << "{\"connections\": " << connections_count
+             << ", \"commands\": " << total_commands
+             << ", \"received\": " << latencies.size()
+             << ", \"bulk_size\": " << bulk_size
+             << ", \"mix\": \"" << mix_name << "\""
+             << ", \"server_threads\": " << pool.size()
+             << ", \"seconds\": " << elapsed.count()
+             << ", \"commands_per_sec\": " << static_cast<double>(latencies.size()) / elapsed.count()
+             << ", \"latency_us\": {\"p50\": " << us(0.5) << ", \"p99\": " << us(0.99)
+             << ", \"p999\": " << us(0.999) << ", \"max\": " << us(1.0) << "}"
+             << ", \"rss_kb\": " << proc_status("VmRSS")
+             << ", \"peak_rss_kb\": " << proc_status("VmHWM")
+             << "}\n";
+        return latencies.size() == total_commands ? 0 : 1;
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << "Exception: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -8,9 +8,13 @@ using namespace std;
 
 BulkCmd BulkCmdManager::general_bulk_;
 std::mutex BulkCmdManager::general_mutex_;
+FlushTimer::Clock::time_point BulkCmdManager::general_start_;
+BulkCmdManager* BulkCmdManager::general_timer_owner_ = nullptr;
 
-BulkCmdManager::BulkCmdManager(std::size_t bulk_max_size)
+BulkCmdManager::BulkCmdManager(std::size_t bulk_max_size, std::chrono::milliseconds max_latency)
     : bulk_capacity_(bulk_max_size),
+      max_latency_(max_latency),
+      timer_(max_latency.count() > 0 ? FlushTimer::instance() : nullptr),
       bulk_handler_(std::make_unique<GeneralStateHandler>())
 #ifdef MULTI_THREAD
     , cout_tread_pool_(1),
@@ -19,6 +23,16 @@ BulkCmdManager::BulkCmdManager(std::size_t bulk_max_size)
 {
 }
 
+BulkCmdManager::~BulkCmdManager() {
+    if (!timer_) return;
+    timer_->cancel(this);
+    // nobody else waits for the common bulk, it's flushed earlier than its deadline
+    lock_guard<mutex> lk(general_mutex_);
+    if (general_timer_owner_ == this) {
+        flush_general_queue();
+    }
+}
+
 void BulkCmdManager::subscribe(ObserverHolder obs) {
     subs_.push_back(move(obs));
 }
@@ -36,12 +50,34 @@ void BulkCmdManager::flush_custom_queue() {
 
 void BulkCmdManager::flush_general_queue() {
     shared_ptr<BulkCmd> data_ptr;
+    general_timer_owner_ = nullptr;
     if (general_bulk_.empty()) return;
     data_ptr = make_shared<BulkCmd>(std::move(general_bulk_));
     general_bulk_.clear();
     notify(std::move(data_ptr));
 }
 
+void BulkCmdManager::start_general_bulk() {
+    general_bulk_.time_ = time(nullptr);
+    if (timer_) {
+        general_start_ = FlushTimer::Clock::now();
+        general_timer_owner_ = this;
+        timer_->schedule(this, general_start_ + max_latency_);
+    }
+}
+
+void BulkCmdManager::on_timer(FlushTimer::Clock::time_point now) {
+    lock_guard<mutex> lk(general_mutex_);
+    if (general_timer_owner_ != this) return;
+    auto deadline = general_start_ + max_latency_;
+    if (now >= deadline) {
+        flush_general_queue();
+    } else {
+        // the entry was armed for the previous bulk
+        timer_->schedule(this, deadline);
+    }
+}
+
 void BulkCmdManager::notify(BulkCmdHolder bulk_cmd) {
 #ifdef MULTI_THREAD
     try {
@@ -79,7 +115,7 @@ void GeneralStateHandler::handle_cmd(BulkCmdManager *m, Command cmd) {
     switch (cmd.cmd_type) {
         case CommandType::Base: {
             if (BulkCmdManager::general_bulk_.empty()) {
-                BulkCmdManager::general_bulk_.time_ = time(nullptr);
+                m->start_general_bulk();
             }
             BulkCmdManager::general_bulk_.data_.push_back(std::move(cmd));
             if (BulkCmdManager::general_bulk_.data_.size() == m->bulk_capacity_) {
@@ -4,8 +4,10 @@
 
     Bulk command manager can accumulate commands in inner buffer.
     If buffer size is equal its capacity, it will flush buffer to its subscribers.
+    Optionally the common bulk is flushed when its oldest command is older than max latency.
 */
 
+#include <chrono>
 #include <vector>
 #include <deque>
 #include <string>
@@ -13,6 +15,7 @@
 #include <mutex>
 
 #include "command.h"
+#include "flush_timer.h"
 #include "thread_pool.h"
 
 #define MULTI_THREAD
@@ -52,14 +55,21 @@ public:
  *
  * Bulk command manager can accumulate commands in inner buffer (method add_cmd).
  * If buffer size is equal its capacity (max_size), it will flush buffer to its subscribers (notify them).
- * It obtains bulk capacity (max_size) in ctor
+ * It obtains bulk capacity (max_size) in ctor.
+ * If max_latency is not zero, the manager that started the common bulk arms the shared FlushTimer
+ * and flushes the bulk when its first command is older than max_latency (or when the manager is destroyed).
+ * A block {} isn't split, it's flushed on its closing brace as before.
  */
-class BulkCmdManager {
+class BulkCmdManager final : private FlushTimer::Client {
 public:
     friend class GeneralStateHandler;
     friend class CustomStateHandler;
 public:
-    explicit BulkCmdManager(std::size_t bulk_max_size);
+    explicit BulkCmdManager(std::size_t bulk_max_size,
+                            std::chrono::milliseconds max_latency = std::chrono::milliseconds(0));
+    ~BulkCmdManager();
+    BulkCmdManager(const BulkCmdManager&) = delete;
+    BulkCmdManager& operator=(const BulkCmdManager&) = delete;
     void subscribe(ObserverHolder obs);
     void add_cmd(Command cmd);
 private:
@@ -70,6 +80,10 @@ private:
     BulkCmd custom_bulk_;
     static std::mutex general_mutex_;
     static BulkCmd general_bulk_;
+    static FlushTimer::Clock::time_point general_start_;    ///< time of the first command of the common bulk
+    static BulkCmdManager* general_timer_owner_;            ///< manager armed the timer for the common bulk
+    std::chrono::milliseconds max_latency_;
+    std::shared_ptr<FlushTimer> timer_;                     ///< only if max latency is set
     std::unique_ptr<BulkStateHandler> bulk_handler_ = nullptr;
 #ifdef MULTI_THREAD
     ThreadPool cout_tread_pool_;
@@ -78,7 +92,9 @@ private:
     // methods
     void flush_custom_queue();
     void flush_general_queue();
+    void start_general_bulk();
     void notify(BulkCmdHolder bulk_cmd);
+    void on_timer(FlushTimer::Clock::time_point now) override;
 };
 using BulkMgrHolder = std::unique_ptr<BulkCmdManager>;
 
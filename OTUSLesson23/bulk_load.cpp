@@ -0,0 +1,95 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+using namespace std;
+namespace ba = boost::asio;
+using boost::asio::ip::tcp;
+
+namespace {
+
+/// commands of one connection, every 100 commands there is a block of 11 commands
+string make_payload(std::size_t commands_count) {
+    string payload;
+    for (std::size_t i = 0; i < commands_count; ++i) {
+        if (i % 100 == 50) {
+            payload += "{\n";
+        }
+        payload += "cmd" + to_string(i) + "\n";
+        if (i % 100 == 60) {
+            payload += "}\n";
+        }
+    }
+    return payload;
+}
+
+} // namespace
+
+// load generator for bulk_server, replaces client.sh
+int main(int argc, char* argv[]) {
+    try
+    {
+        if (argc < 3)
+        {
+            std::cerr << "Usage: bulk_load <host> <port> [connections] [commands] [threads]\n";
+            return 1;
+        }
+        std::size_t connections_count = argc > 3 ? stoul(argv[3]) : 1000;
+        std::size_t commands_count = argc > 4 ? stoul(argv[4]) : 1000;
+        std::size_t threads_count = argc > 5 ? stoul(argv[5]) : 8;
+
+        ba::io_service io_context;
+        tcp::resolver resolver(io_context);
+        auto endpoints = resolver.resolve(tcp::resolver::query(argv[1], argv[2]));
+        tcp::endpoint endpoint = *endpoints;
+        const string payload = make_payload(commands_count);
+
+        // connections are opened one by one in every thread, each sends all commands and closes
+        atomic<std::size_t> next_connection{0};
+        atomic<std::size_t> failed{0};
+        auto start = chrono::steady_clock::now();
+        vector<thread> threads;
+        for (std::size_t t = 0; t < threads_count; ++t) {
+            threads.emplace_back([&] {
+                ba::io_service io;
+                while (next_connection.fetch_add(1) < connections_count) {
+                    boost::system::error_code ec;
+                    tcp::socket socket(io);
+                    socket.connect(endpoint, ec);
+                    if (!ec) {
+                        ba::write(socket, ba::buffer(payload), ec);
+                    }
+                    if (ec) {
+                        ++failed;
+                        continue;
+                    }
+                    socket.shutdown(tcp::socket::shutdown_send, ec);
+                    socket.close(ec);
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+        auto done = static_cast<double>(connections_count - failed.load());
+        cout << "connections: " << connections_count << ", failed: " << failed.load()
+             << ", commands per connection: " << commands_count
+             << ", time: " << elapsed.count() << " s\n"
+             << "connections/s: " << done / elapsed.count()
+             << ", commands/s: " << done * static_cast<double>(commands_count) / elapsed.count() << "\n";
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << "Exception: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
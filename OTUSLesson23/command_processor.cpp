@@ -1,6 +1,6 @@
 #include "command_processor.h"
 
-#include <string_view>
+#include <utility>
 
 using namespace std;
 
@@ -12,21 +12,3 @@ void process_all_commands(ICmdReader& cmdReader, BulkCmdManager& bulkMgr) {
         if (to_break) break;
     }
 }
-
-void CommandProcessor::pushToBuffer(const char *data, std::size_t data_size) {
-    string_view sv(data, data_size);
-    auto& buffer = buffer_;
-    while (!sv.empty()) {
-        auto pos = sv.find('\n');
-
-        if (pos != std::string_view::npos) {
-            ++pos;
-        }
-        if (cmdReader_->isCmdComplete()) {
-            buffer.emplace_back(sv.substr(0, pos));
-        } else {
-            buffer.back() += string(sv.substr(0, pos));
-        }
-        sv.remove_prefix(min(pos, sv.size()));
-    }
-}
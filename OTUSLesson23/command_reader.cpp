@@ -1,5 +1,6 @@
 #include "command_reader.h"
 
+#include <cstring>
 #include <utility>
 #include <string>
 
@@ -28,25 +29,48 @@ bool StreamCmdReader::hasCmd() {
     return static_cast<bool>(in_);
 }
 
-// QueueReader2
-Command QueueReader::read_next_cmd() {
-    auto cmd_line = move(buffer_.front());
-    buffer_.pop_front();
-    if (!cmd_line.empty() && cmd_line.back() == '\n') {
-        cmd_line.pop_back();
-    }
-    return getCmd(move(cmd_line));
+// ChunkCmdReader
+void ChunkCmdReader::feed(const char* data, std::size_t size) {
+    chunk_ = std::string_view(data, size);
+    eol_ = nullptr;
 }
 
-bool QueueReader::hasCmd() {
-    return !buffer_.empty() && !buffer_.front().empty()
-           && buffer_.front().back() == '\n';
+Command ChunkCmdReader::read_next_cmd() {
+    if (!hasCmd()) {
+        if (tail_.empty()) {
+            return Command{CommandType::Terminator};
+        }
+        // data ends without eol
+        auto cmd_line = move(tail_);
+        tail_.clear();
+        return getCmd(move(cmd_line));
+    }
+    auto len = static_cast<std::size_t>(eol_ - chunk_.data());
+    auto cmd_line = chunk_.substr(0, len);
+    chunk_.remove_prefix(len + 1);
+    eol_ = nullptr;
+    if (tail_.empty()) {
+        return getCmd(string(cmd_line));
+    }
+    auto line = move(tail_);
+    tail_.clear();
+    line += cmd_line;
+    return getCmd(move(line));
 }
 
-bool QueueReader::isCmdComplete() {
-    if (!buffer_.empty() && !buffer_.back().empty()) {
-        return buffer_.back().back() == '\n';
-    } else {
+bool ChunkCmdReader::hasCmd() {
+    if (eol_) {
+        return true;
+    }
+    if (chunk_.empty()) {
+        return false;
+    }
+    eol_ = static_cast<const char*>(memchr(chunk_.data(), '\n', chunk_.size()));
+    if (eol_) {
         return true;
     }
+    // the chunk is reused after reading, the rest is kept till the next one
+    tail_ += chunk_;
+    chunk_ = {};
+    return false;
 }
@@ -7,8 +7,8 @@
 
 #include <iostream>
 #include <memory>
-#include <deque>
 #include <string>
+#include <string_view>
 
 #include "command.h"
 
@@ -43,16 +43,22 @@ private:
     std::istream& in_;
 };
 
-class QueueReader : public ICmdReader {
+/**
+ *  @brief Incremental command reader from received chunks
+ *
+ *  Chunk is parsed in place, eol is searched with memchr.
+ *  Only the partial line at the end of a chunk is copied, it's completed by the next chunk.
+ */
+class ChunkCmdReader : public ICmdReader {
 public:
-    explicit QueueReader(std::deque<std::string>& buffer)
-        : buffer_(buffer)
-    {}
+    /// chunk isn't copied, it must be valid until hasCmd() returns false
+    void feed(const char* data, std::size_t size);
+    /// complete line, or the partial line when there is no complete one
     Command read_next_cmd() override;
     bool hasCmd() override;
-    bool isCmdComplete() override;
+    bool isCmdComplete() override {return tail_.empty() && chunk_.empty();}
 private:
-    std::deque<std::string>& buffer_;
+    std::string_view chunk_;        ///< not read data of the current chunk
+    const char* eol_ = nullptr;     ///< eol in chunk_ found by hasCmd
+    std::string tail_;              ///< partial line of the previous chunks
 };
-
-
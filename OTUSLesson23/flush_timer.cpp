@@ -0,0 +1,116 @@
+#include "flush_timer.h"
+
+#include <algorithm>
+
+using namespace std;
+
+FlushTimer::FlushTimer(std::chrono::milliseconds tick, std::size_t slots_count)
+    : tick_(tick), start_(Clock::now()), slots_(slots_count),
+      worker_(&FlushTimer::run, this)
+{}
+
+FlushTimer::~FlushTimer() {
+    {
+        lock_guard lk(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    worker_.join();
+}
+
+std::shared_ptr<FlushTimer> FlushTimer::instance() {
+    static auto timer = make_shared<FlushTimer>();
+    return timer;
+}
+
+void FlushTimer::schedule(Client* client, Clock::time_point deadline) {
+    bool is_earlier = false;
+    {
+        lock_guard lk(mtx_);
+        remove(client);
+        // a past deadline is fired by the next tick
+        auto tick = max(tickOf(deadline), next_tick_);
+        auto slot = tick % slots_.size();
+        slots_[slot].push_back(Entry{client, deadline});
+        client_slots_[client] = slot;
+        is_earlier = tick < wake_tick_;
+    }
+    if (is_earlier) {
+        cv_.notify_one();
+    }
+}
+
+void FlushTimer::cancel(Client* client) {
+    // waits for the client called now, it can schedule itself again
+    lock_guard run_lk(run_mtx_);
+    lock_guard lk(mtx_);
+    remove(client);
+}
+
+std::size_t FlushTimer::tickOf(Clock::time_point time) const {
+    auto ticks = (time - start_ + tick_ - Clock::duration(1)) / tick_;
+    return static_cast<std::size_t>(max<Clock::rep>(ticks, 0));
+}
+
+std::size_t FlushTimer::passedTick(Clock::time_point time) const {
+    return static_cast<std::size_t>(max<Clock::rep>((time - start_) / tick_, 0));
+}
+
+std::size_t FlushTimer::nextBusyTick() const {
+    for (std::size_t i = 0; i < slots_.size(); ++i) {
+        if (!slots_[(next_tick_ + i) % slots_.size()].empty()) {
+            return next_tick_ + i;
+        }
+    }
+    return next_tick_ + slots_.size();
+}
+
+void FlushTimer::remove(Client* client) {
+    auto it = client_slots_.find(client);
+    if (it == client_slots_.end()) return;
+    auto& slot = slots_[it->second];
+    slot.erase(find_if(slot.begin(), slot.end(), [client](const Entry& e) {return e.client == client;}));
+    client_slots_.erase(it);
+}
+
+void FlushTimer::run() {
+    vector<Entry> expired;
+    while (true) {
+        {
+            unique_lock lk(mtx_);
+            wake_tick_ = NO_TICK;
+            cv_.wait(lk, [this] {return stop_ || !client_slots_.empty();});
+            if (stop_) return;
+            // an entry of a later round wakes the thread once per round
+            wake_tick_ = nextBusyTick();
+            auto wake_time = start_ + tick_ * static_cast<Clock::rep>(wake_tick_);
+            if (Clock::now() < wake_time) {
+                // schedule notifies if it adds an entry before wake_tick_
+                cv_.wait_until(lk, wake_time);
+                continue;
+            }
+        }
+        lock_guard run_lk(run_mtx_);
+        auto now = Clock::now();
+        {
+            lock_guard lk(mtx_);
+            // entry is in the slot of its deadline tick (rounded up), so it's expired when the tick is passed;
+            // entries of later rounds stay, one round covers all slots after a long pause
+            auto now_tick = passedTick(now);
+            for (std::size_t i = 0; next_tick_ <= now_tick && i < slots_.size(); ++next_tick_, ++i) {
+                auto& slot = slots_[next_tick_ % slots_.size()];
+                auto rest = partition(slot.begin(), slot.end(), [now](const Entry& e) {return e.deadline > now;});
+                for (auto it = rest; it != slot.end(); ++it) {
+                    client_slots_.erase(it->client);
+                    expired.push_back(*it);
+                }
+                slot.erase(rest, slot.end());
+            }
+            next_tick_ = max(next_tick_, now_tick + 1);
+        }
+        for (auto& entry : expired) {
+            entry.client->on_timer(now);
+        }
+        expired.clear();
+    }
+}
@@ -1,8 +1,10 @@
+#include <chrono>
 #include <iostream>
 
 #include <boost/asio.hpp>
 
 #include "async_server.h"
+#include "async_subscribe.h"
 
 using namespace std;
 namespace ba = boost::asio;
@@ -11,19 +13,25 @@ using boost::asio::ip::tcp;
 int main(int argc, char* argv[]) {
     try
     {
-        if (argc < 2)
+        if (argc < 3)
         {
-            std::cerr << "Usage: bulk_server <port> <bulksize>\n";
+            std::cerr << "Usage: bulk_server <port> <bulksize> [threads] [max_latency_ms]\n";
             return 1;
         }
 
-        ba::io_service io_context;
+        // 0 -- thread per core
+        size_t threads_count = argc > 3 ? stoul(argv[3]) : 0;
+        IoServicePool pool(threads_count);
+        // 0 -- bulk waits for its size
+        if (argc > 4) {
+            async::set_max_latency(chrono::milliseconds(stoul(argv[4])));
+        }
 
-        tcp::endpoint endpoint(tcp::v4(), stol(argv[1]));
-        size_t bulk_size = stol(argv[2]);
-        BulkAsyncServer server(io_context, endpoint, bulk_size);
+        tcp::endpoint endpoint(tcp::v4(), static_cast<unsigned short>(stoul(argv[1])));
+        size_t bulk_size = stoul(argv[2]);
+        BulkAsyncServer server(pool, endpoint, bulk_size);
 
-        io_context.run();
+        pool.run();
     }
     catch (std::exception& e)
     {
@@ -1,13 +1,187 @@
 #define BOOST_TEST_MODULE bulk_server_test_module
 #include <boost/test/unit_test.hpp>
 
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "async_server.h"
+#include "async_subscribe.h"
+#include "bulk.h"
+#include "command_handler.h"
+#include "command_reader.h"
 
 using namespace std;
+using namespace std::chrono_literals;
+using boost::asio::ip::tcp;
 
 BOOST_AUTO_TEST_SUITE(bulk_server_test_suite)
 
-	BOOST_AUTO_TEST_CASE(test_) {
+	/// records bulks as "cmd1, cmd2, ..."
+	class RecordingHandler : public IObserver {
+	public:
+		RecordingHandler(vector<string>& bulks, mutex& mtx)
+			: bulks_(bulks), mtx_(mtx) {}
+
+		void update(BulkCmdHolder bulk_holder) override {
+			string bulk;
+			for (const auto& cmd : bulk_holder->getData()) {
+				bulk += (bulk.empty() ? "" : ", ") + cmd.data;
+			}
+			lock_guard lk(mtx_);
+			bulks_.push_back(bulk);
+		}
+	private:
+		vector<string>& bulks_;
+		mutex& mtx_;
+	};
+
+	BOOST_AUTO_TEST_CASE(test_server) {
+		vector<string> bulks;
+		mutex mtx;
+		async::set_subscribe([&bulks, &mtx](BulkCmdManager& bulkMgr) {
+			createObserverAndSubscribe<RecordingHandler>(&bulkMgr, bulks, mtx);
+		});
+		IoServicePool pool(2);
+		BulkAsyncServer server(pool, tcp::endpoint(ba::ip::address_v4::loopback(), 0), 3);
+		thread server_thread([&pool] {pool.run();});
+		{
+			ba::io_service io;
+			tcp::socket socket(io);
+			socket.connect(server.endpoint());
+			socket.set_option(tcp::no_delay(true));
+			// lines are split between packets, the last one has no eol
+			for (string_view packet : {"0\n1", "\n2\n3\n{\n4\n", "5\n}\n6\n7\n8\n9"}) {
+				ba::write(socket, ba::buffer(packet.data(), packet.size()));
+				this_thread::sleep_for(10ms);
+			}
+			socket.close();
+		}
+		auto last_bulk = [&bulks, &mtx] {
+			lock_guard lk(mtx);
+			return bulks.empty() ? string() : bulks.back();
+		};
+		for (int i = 0; i < 500 && last_bulk() != "9"; ++i) {
+			this_thread::sleep_for(10ms);
+		}
+		pool.stop();
+		server_thread.join();
+		async::set_subscribe([](BulkCmdManager&) {});
+
+		lock_guard lk(mtx);
+		BOOST_CHECK(bulks == vector<string>({"0, 1, 2", "3", "4, 5", "6, 7, 8", "9"}));
+	}
+
+	using Clock = chrono::steady_clock;
+
+	/// records flush time and size of every bulk
+	class FlushTimeHandler : public IObserver {
+	public:
+		FlushTimeHandler(vector<pair<Clock::time_point, size_t>>& flushes, mutex& mtx)
+			: flushes_(flushes), mtx_(mtx) {}
+
+		void update(BulkCmdHolder bulk_holder) override {
+			auto now = Clock::now();
+			lock_guard lk(mtx_);
+			flushes_.emplace_back(now, bulk_holder->getData().size());
+		}
+	private:
+		vector<pair<Clock::time_point, size_t>>& flushes_;
+		mutex& mtx_;
+	};
+
+	BOOST_AUTO_TEST_CASE(test_max_latency) {
+		constexpr auto T = 50ms;
+		constexpr auto SLACK = 40ms;
+		vector<pair<Clock::time_point, size_t>> flushes;
+		mutex mtx;
+		async::set_subscribe([&flushes, &mtx](BulkCmdManager& bulkMgr) {
+			createObserverAndSubscribe<FlushTimeHandler>(&bulkMgr, flushes, mtx);
+		});
+		async::set_max_latency(T);
+		IoServicePool pool(1);
+		BulkAsyncServer server(pool, tcp::endpoint(ba::ip::address_v4::loopback(), 0), 100);
+		thread server_thread([&pool] {pool.run();});
+		vector<Clock::time_point> sent;
+		{
+			ba::io_service io;
+			tcp::socket socket(io);
+			socket.connect(server.endpoint());
+			socket.set_option(tcp::no_delay(true));
+			// slow client: a command every 15 ms, bulk is never full
+			for (int i = 0; i < 12; ++i) {
+				auto packet = to_string(i) + "\n";
+				sent.push_back(Clock::now());
+				ba::write(socket, ba::buffer(packet));
+				this_thread::sleep_for(15ms);
+			}
+			this_thread::sleep_for(T + SLACK);
+			socket.close();
+		}
+		this_thread::sleep_for(SLACK);
+		pool.stop();
+		server_thread.join();
+		async::set_max_latency(0ms);
+		async::set_subscribe([](BulkCmdManager&) {});
+
+		lock_guard lk(mtx);
+		BOOST_REQUIRE(flushes.size() > 1);
+		size_t first = 0;
+		for (const auto& [time, size] : flushes) {
+			// the oldest command of the bulk waited T, but not much longer
+			BOOST_CHECK(time - sent[first] >= T);
+			BOOST_CHECK(time - sent[first] <= T + SLACK);
+			first += size;
+		}
+		BOOST_CHECK(first == sent.size());
+	}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(chunk_cmd_reader_test_suite)
+
+	/// reads all complete commands of the chunk
+	vector<string> read_all(ChunkCmdReader& commandReader, string_view chunk) {
+		commandReader.feed(chunk.data(), chunk.size());
+		vector<string> res;
+		while (commandReader.hasCmd()) {
+			auto cmd = commandReader.read_next_cmd();
+			switch (cmd.cmd_type) {
+				case CommandType::StartCustomBulk: res.emplace_back("{"); break;
+				case CommandType::StopCustomBulk: res.emplace_back("}"); break;
+				default: res.push_back(cmd.data);
+			}
+		}
+		return res;
+	}
+
+	BOOST_AUTO_TEST_CASE(test_lines) {
+		ChunkCmdReader commandReader;
+		BOOST_CHECK(read_all(commandReader, "cmd1\n{\n\ncmd2\n}\n") == vector<string>({"cmd1", "{", "", "cmd2", "}"}));
+		BOOST_CHECK(commandReader.isCmdComplete());
+	}
+
+	BOOST_AUTO_TEST_CASE(test_split_lines) {
+		ChunkCmdReader commandReader;
+		BOOST_CHECK(read_all(commandReader, "cm").empty());
+		BOOST_CHECK(!commandReader.isCmdComplete());
+		// the chunk memory is reused by the server
+		string chunk = "d1\ncmd2\ncmd";
+		BOOST_CHECK(read_all(commandReader, chunk) == vector<string>({"cmd1", "cmd2"}));
+		chunk = "xxxxx";
+		BOOST_CHECK(read_all(commandReader, "3\ncmd") == vector<string>({"cmd3"}));
 
+		// connection is closed without eol
+		BOOST_REQUIRE(!commandReader.isCmdComplete());
+		auto cmd = commandReader.read_next_cmd();
+		BOOST_CHECK(cmd.cmd_type == CommandType::Base);
+		BOOST_CHECK(cmd.data == "cmd");
+		BOOST_CHECK(commandReader.isCmdComplete());
 	}
 
 BOOST_AUTO_TEST_SUITE_END()
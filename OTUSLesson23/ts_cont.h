@@ -12,6 +12,8 @@ public:
     const T& operator[](std::size_t idx) const;
 
     void erase(std::size_t idx);
+    /// removes the element, returns it and the number of remaining elements (atomically)
+    std::pair<T, std::size_t> extract(std::size_t idx);
 
     // getters and checkers
     [[nodiscard]] bool contains(std::size_t key) const {
@@ -54,3 +56,11 @@ void ThreadSafeUnorderedMap<T>::erase(std::size_t idx) {
     std::unique_lock<std::shared_mutex> lk(data_mtx_);
     data_.erase(idx);
 }
+
+template<typename T>
+std::pair<T, std::size_t> ThreadSafeUnorderedMap<T>::extract(std::size_t idx) {
+    std::unique_lock<std::shared_mutex> lk(data_mtx_);
+    auto value = std::move(data_[idx]);
+    data_.erase(idx);
+    return {std::move(value), data_.size()};
+}
@@ -0,0 +1,60 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include "ip_filter.h"
+#include "ip_pool_packed.h"
+
+using namespace std;
+
+template <typename F>
+double measure(F f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    constexpr size_t N = 2'000'000;
+    mt19937 gen(42);
+    uniform_int_distribution<unsigned> dist(0, 255);
+    string data;
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = 0; j < IP_SIZE; ++j) {
+            if (j != 0) data += '.';
+            data += to_string(dist(gen));
+        }
+        data += "\t1\t2\n";
+    }
+    auto gb = static_cast<double>(data.size()) / 1e9;
+
+    IPPool ip_pool;
+    double read_time = measure([&]{
+        stringstream in(data);
+        ip_pool = read_ips(in);
+    });
+    PackedIPPool packed_pool;
+    double parse_time = measure([&]{
+        packed_pool = parse_ips_packed(data);
+    });
+    cout << "read_ips:         " << gb / read_time << " GB/s\n";
+    cout << "parse_ips_packed: " << gb / parse_time << " GB/s\n";
+
+    double sort_time = measure([&]{
+        reverse_sort_ip_pool(ip_pool);
+    });
+    double radix_time = measure([&]{
+        reverse_radix_sort_ip_pool(packed_pool);
+    });
+    auto mips = static_cast<double>(N) / 1e6;
+    cout << "reverse_sort_ip_pool:       " << mips / sort_time << " M ips/s\n";
+    cout << "reverse_radix_sort_ip_pool: " << mips / radix_time << " M ips/s\n";
+    if (unpack_ip_pool(packed_pool) != ip_pool) {
+        cerr << "sort results differ\n";
+        return 1;
+    }
+    return 0;
+}
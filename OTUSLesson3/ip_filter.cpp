@@ -1,6 +1,7 @@
 #include "ip_filter.h"
 
 #include <algorithm>
+#include <stdexcept>
 #include <tuple>
 
 #include "str_utils.h"
@@ -0,0 +1,64 @@
+#include "ip_pool_index.h"
+
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+using namespace std;
+
+IPPoolIndex::IPPoolIndex(PackedIPPool ip_pool)
+    : ips_(std::move(ip_pool))
+{
+    if (ips_.size() > numeric_limits<Position>::max()) {
+        throw length_error("ip pool is too big for IPPoolIndex");
+    }
+    reverse_radix_sort_ip_pool(ips_);
+    for (size_t part_num = 0; part_num < IP_SIZE; ++part_num) {
+        auto& octet_index = octets_[part_num];
+        const unsigned shift = 8u * static_cast<unsigned>(IP_SIZE - 1 - part_num);
+        // counting sort of positions by ip-part value, positions stay sorted inside value
+        for (auto ip : ips_) {
+            ++octet_index.offsets[((ip >> shift) & 0xffu) + 1];
+        }
+        for (size_t value = 0; value < VALUES_COUNT; ++value) {
+            octet_index.offsets[value + 1] += octet_index.offsets[value];
+        }
+        octet_index.positions.resize(ips_.size());
+        auto next = octet_index.offsets;
+        for (size_t pos = 0; pos < ips_.size(); ++pos) {
+            octet_index.positions[next[(ips_[pos] >> shift) & 0xffu]++] = static_cast<Position>(pos);
+        }
+    }
+}
+
+IPPoolIndex::IndexRange IPPoolIndex::octet(size_t part_num, IPPart value) const {
+    const auto& octet_index = octets_.at(part_num);
+    const auto* data = octet_index.positions.data();
+    return IndexRange(data + octet_index.offsets[value], data + octet_index.offsets[value + 1u]);
+}
+
+IPPoolIndex::IndexSet IPPoolIndex::any_octet(IPPart value) const {
+    IndexSet res;
+    for (size_t part_num = 0; part_num < IP_SIZE; ++part_num) {
+        res = index_or(res, octet(part_num, value));
+    }
+    return res;
+}
+
+IPPoolIndex::IndexSet IPPoolIndex::cidr(const IPAddress& net, unsigned prefix_len) const {
+    if (prefix_len > 32) {
+        throw invalid_argument("Incorrect CIDR prefix length");
+    }
+    const PackedIP mask = prefix_len == 0 ? 0u : ~PackedIP(0) << (32u - prefix_len);
+    const PackedIP first_ip = pack_ip(net) & mask;
+    const PackedIP last_ip = first_ip | ~mask;
+    // ips_ is sorted in descending order
+    auto first = lower_bound(ips_.begin(), ips_.end(), last_ip, greater<>());
+    auto last = upper_bound(first, ips_.end(), first_ip, greater<>());
+    IndexSet res(static_cast<size_t>(last - first));
+    auto pos = static_cast<Position>(first - ips_.begin());
+    for (auto& p : res) {
+        p = pos++;
+    }
+    return res;
+}
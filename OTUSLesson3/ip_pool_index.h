@@ -0,0 +1,77 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "ip_filter.h"
+#include "ip_pool_packed.h"
+#include "iterator_range.h"
+
+/**
+ * @brief Index over ip-address pool for arbitrary octet, any-octet and CIDR queries
+ *
+ * Pool is kept as reverse sorted PackedIPPool (the same order as reverse_sort_ip_pool gives),
+ * query result is a sorted set of positions in this pool, so it is already in output order.
+ * For every octet position there is an inverted index: value -> sorted positions of ips
+ * which have this value at this position (stored as one flat array with offsets).
+ * octet      -- O(1), returns ready posting list
+ * any_octet  -- merge of 4 posting lists, O(k)
+ * cidr       -- binary search in the sorted pool, O(logN + k)
+ * index_and / index_or -- intersection / union of sorted position sets
+ */
+class IPPoolIndex {
+public:
+    using Position = std::uint32_t;
+    using IndexSet = std::vector<Position>;
+    using IndexRange = IteratorRange<const Position*>;
+
+    explicit IPPoolIndex(PackedIPPool ip_pool);
+
+    [[nodiscard]] std::size_t size() const {return ips_.size();}
+    [[nodiscard]] const PackedIPPool& ips() const {return ips_;}
+
+    /// positions of ips with ip[part_num] == value
+    [[nodiscard]] IndexRange octet(std::size_t part_num, IPPart value) const;
+    /// positions of ips with any ip-part == value
+    [[nodiscard]] IndexSet any_octet(IPPart value) const;
+    /// positions of ips from net/prefix_len subnet
+    [[nodiscard]] IndexSet cidr(const IPAddress& net, unsigned prefix_len) const;
+    /// ip-addresses for the positions
+    template <typename Range>
+    [[nodiscard]] IPPool select(const Range& positions) const {
+        IPPool res;
+        for (auto pos : positions) {
+            res.push_back(unpack_ip(ips_[pos]));
+        }
+        return res;
+    }
+
+private:
+    static constexpr std::size_t VALUES_COUNT = 256;
+    struct OctetIndex {
+        std::array<std::size_t, VALUES_COUNT + 1> offsets{};
+        std::vector<Position> positions;
+    };
+
+    PackedIPPool ips_;
+    std::array<OctetIndex, IP_SIZE> octets_;
+};
+
+/// intersection of sorted position sets
+template <typename Range1, typename Range2>
+IPPoolIndex::IndexSet index_and(const Range1& lhs, const Range2& rhs) {
+    IPPoolIndex::IndexSet res;
+    std::set_intersection(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::back_inserter(res));
+    return res;
+}
+
+/// union of sorted position sets
+template <typename Range1, typename Range2>
+IPPoolIndex::IndexSet index_or(const Range1& lhs, const Range2& rhs) {
+    IPPoolIndex::IndexSet res;
+    std::set_union(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::back_inserter(res));
+    return res;
+}
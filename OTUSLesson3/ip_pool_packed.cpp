@@ -0,0 +1,157 @@
+#include "ip_pool_packed.h"
+
+#include <array>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+class MappedFile {
+public:
+    explicit MappedFile(const string& filename) {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw runtime_error("can't open file "s + filename);
+        }
+        struct stat st{};
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw runtime_error("can't stat file "s + filename);
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ != 0) {
+            void* addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED) {
+                ::close(fd);
+                throw runtime_error("can't mmap file "s + filename);
+            }
+            data_ = static_cast<const char*>(addr);
+            madvise(addr, size_, MADV_SEQUENTIAL);
+        }
+        ::close(fd);
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() {
+        if (data_) {
+            munmap(const_cast<char*>(data_), size_);
+        }
+    }
+    string_view data() const {return {data_, size_};}
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+/// parses ip-address at the beginning of [p, end), it must be followed by tab or end
+PackedIP parse_packed_ip(const char*& p, const char* end) {
+    PackedIP res = 0;
+    for (size_t i = 0; i < IP_SIZE; ++i) {
+        if (i != 0) {
+            if (p == end || *p != '.') {
+                throw invalid_argument("Incorrect number of fields in ip");
+            }
+            ++p;
+        }
+        unsigned part = 0;
+        const char* start = p;
+        while (p != end && static_cast<unsigned>(*p - '0') < 10u) {
+            part = part * 10 + static_cast<unsigned>(*p - '0');
+            ++p;
+        }
+        if (p == start || p - start > 3 || part > 255) {
+            throw invalid_argument("Incorrect ip-part in ip");
+        }
+        res = (res << 8) | part;
+    }
+    if (p != end && *p != '\t') {
+        throw invalid_argument("Incorrect number of fields in ip");
+    }
+    return res;
+}
+
+} // namespace
+
+PackedIP pack_ip(const IPAddress& ip_address) {
+    PackedIP res = 0;
+    for (auto ip_part : ip_address) {
+        res = (res << 8) | ip_part;
+    }
+    return res;
+}
+
+IPAddress unpack_ip(PackedIP ip_address) {
+    IPAddress res;
+    for (size_t i = IP_SIZE; i != 0; --i) {
+        res[i - 1] = static_cast<IPPart>(ip_address & 0xffu);
+        ip_address >>= 8;
+    }
+    return res;
+}
+
+IPPool unpack_ip_pool(const PackedIPPool& ip_pool) {
+    IPPool res;
+    res.reserve(ip_pool.size());
+    for (auto ip : ip_pool) {
+        res.push_back(unpack_ip(ip));
+    }
+    return res;
+}
+
+PackedIPPool parse_ips_packed(string_view data) {
+    PackedIPPool ip_pool;
+    // ~ minimal line length "0.0.0.0\n" to avoid reallocations
+    ip_pool.reserve(data.size() / 16);
+    const char* p = data.data();
+    const char* end = p + data.size();
+    while (p != end) {
+        // line end is searched by memchr which is vectorized in libc
+        auto line_end = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(end - p)));
+        if (!line_end) {
+            line_end = end;
+        }
+        ip_pool.push_back(parse_packed_ip(p, line_end));
+        p = line_end == end ? end : line_end + 1;
+    }
+    return ip_pool;
+}
+
+PackedIPPool read_ips_packed(const string& filename) {
+    MappedFile file(filename);
+    return parse_ips_packed(file.data());
+}
+
+PackedIPPool read_ips_packed(istream& in) {
+    string data{istreambuf_iterator<char>(in), istreambuf_iterator<char>()};
+    return parse_ips_packed(data);
+}
+
+void reverse_radix_sort_ip_pool(PackedIPPool& ip_pool) {
+    constexpr size_t RADIX = 256;
+    PackedIPPool buffer(ip_pool.size());
+    for (unsigned shift = 0; shift < 32; shift += 8) {
+        array<size_t, RADIX> counts{};
+        for (auto ip : ip_pool) {
+            ++counts[(ip >> shift) & 0xffu];
+        }
+        // descending order: positions for bigger digits go first
+        size_t pos = 0;
+        for (size_t digit = RADIX; digit != 0; --digit) {
+            auto count = counts[digit - 1];
+            counts[digit - 1] = pos;
+            pos += count;
+        }
+        for (auto ip : ip_pool) {
+            buffer[counts[(ip >> shift) & 0xffu]++] = ip;
+        }
+        ip_pool.swap(buffer);
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ip_filter.h"
+
+// packed ip-address: the first ip-part is the most significant byte,
+// so the order of packed values is the same as the order of IPAddress
+using PackedIP = std::uint32_t;
+using PackedIPPool = std::vector<PackedIP>;
+
+PackedIP pack_ip(const IPAddress& ip_address);
+IPAddress unpack_ip(PackedIP ip_address);
+IPPool unpack_ip_pool(const PackedIPPool& ip_pool);
+
+/// parses all lines of data, ip-address is the first tab-separated field of the line
+PackedIPPool parse_ips_packed(std::string_view data);
+/// mmap-s the file and parses it with parse_ips_packed
+PackedIPPool read_ips_packed(const std::string& filename);
+/// reads the whole stream and parses it with parse_ips_packed
+PackedIPPool read_ips_packed(std::istream& in);
+
+/// 4-pass LSD radix sort, gives the same order as reverse_sort_ip_pool
+void reverse_radix_sort_ip_pool(PackedIPPool& ip_pool);
@@ -2,24 +2,27 @@
 #include <sstream>
 
 #include "ip_filter.h"
+#include "ip_pool_packed.h"
+#include "ip_pool_index.h"
 
-int main([[maybe_unused]]int argc, [[maybe_unused]]char const *argv[])
+int main(int argc, char const *argv[])
 {
     using namespace std;
     try
     {
-        auto ip_pool = read_ips(cin);
-        sort(ip_pool.begin(), ip_pool.end(), std::greater<IPAddress>());
-        cout << ip_pool << endl;
+        // ip_filter [file] -- file is mmap-ed, otherwise stdin is read
+        auto packed_pool = argc > 1 ? read_ips_packed(string(argv[1])) : read_ips_packed(cin);
+        IPPoolIndex index(std::move(packed_pool));
+        cout << unpack_ip_pool(index.ips()) << endl;
 
         // filter: first byte == 1 and output
-        cout << ip_filter(IteratorRange(ip_pool.begin(), ip_pool.end()), IPPart(1)) << endl;
+        cout << index.select(index.octet(0, IPPart(1))) << endl;
 
         // filter: fb==46, sb==70 and output
-        cout << ip_filter(IteratorRange(ip_pool.begin(), ip_pool.end()), IPPart(46), IPPart(70)) << endl;
+        cout << index.select(index_and(index.octet(0, IPPart(46)), index.octet(1, IPPart(70)))) << endl;
 
         // filter: any_byte == 46
-        cout << ip_filter_copy_any(ip_pool, IPPart(46)) << endl;
+        cout << index.select(index.any_octet(IPPart(46))) << endl;
     }
     catch(const std::exception &e)
     {
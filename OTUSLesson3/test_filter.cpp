@@ -5,6 +5,8 @@
 
 #include "ip_filter.h"
 #include "str_utils.h"
+#include "ip_pool_packed.h"
+#include "ip_pool_index.h"
 
 using namespace std;
 
@@ -245,6 +247,66 @@ BOOST_AUTO_TEST_CASE(test_reverse_sort_ip_pool) {
 
 BOOST_AUTO_TEST_SUITE_END()
 
+BOOST_AUTO_TEST_SUITE(packed_ip_test_suite)
+
+BOOST_AUTO_TEST_CASE(test_pack_ip) {
+    BOOST_CHECK(pack_ip({127, 0, 0, 1}) == 0x7f000001u);
+    BOOST_CHECK(unpack_ip(0x7f000001u) == (IPAddress{127, 0, 0, 1}));
+    BOOST_CHECK(unpack_ip(pack_ip({255, 1, 128, 0})) == (IPAddress{255, 1, 128, 0}));
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_ips_packed) {
+    {
+        string data = "113.162.145.156	111	0 \n"
+                      "157.39.22.224	5	6\n"
+                      "0.0.0.0\n"
+                      "1.1.1.1\t2 3 54 65 6  788 99";
+        auto ip_pool = unpack_ip_pool(parse_ips_packed(data));
+        IPPool expected{{113, 162, 145, 156},
+                        {157, 39, 22, 224},
+                        {0, 0, 0, 0},
+                        {1, 1, 1, 1},
+        };
+        BOOST_CHECK(ip_pool == expected);
+    }
+    {
+        stringstream in;
+        in << "79.180.73.190	2	1  \n";
+        auto ip_pool = read_ips_packed(in);
+        BOOST_CHECK(ip_pool == PackedIPPool{pack_ip({79, 180, 73, 190})});
+    }
+    BOOST_CHECK(parse_ips_packed("").empty());
+    BOOST_CHECK_THROW(parse_ips_packed("1.1.1\n"), invalid_argument);
+    BOOST_CHECK_THROW(parse_ips_packed("1.1.1.256\n"), invalid_argument);
+    BOOST_CHECK_THROW(parse_ips_packed("1.1.1.1\n\n"), invalid_argument);
+    BOOST_CHECK_THROW(parse_ips_packed("1.2.3.4.5\tx\n"), invalid_argument);
+    BOOST_CHECK_THROW(parse_ips_packed("1.2.3.4x\t1\n"), invalid_argument);
+    BOOST_CHECK_THROW(parse_ips_packed("1.2.3.4 1\t2\n"), invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(test_reverse_radix_sort_ip_pool) {
+    IPPool ip_pool{{113, 162, 145, 156},
+                    {157, 39, 22, 224},
+                    {79, 180, 73, 190},
+                    {179, 210, 145, 4},
+                    {0, 0, 0, 0},
+                    {1, 2, 1, 1},
+                    {1, 1, 1, 1},
+                    {1, 1, 2, 1},
+                    {1, 1, 1, 2},
+                    {255, 255, 255, 255},
+    };
+    PackedIPPool packed_pool;
+    for (const auto& ip : ip_pool) {
+        packed_pool.push_back(pack_ip(ip));
+    }
+    reverse_radix_sort_ip_pool(packed_pool);
+    reverse_sort_ip_pool(ip_pool);
+    BOOST_CHECK(unpack_ip_pool(packed_pool) == ip_pool);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
 BOOST_AUTO_TEST_SUITE(ip_filter_test_suite)
 
 BOOST_AUTO_TEST_CASE(test_ip_filter_equal) {
@@ -318,3 +380,97 @@ BOOST_AUTO_TEST_CASE(test_ip_filter_any) {
 }
 
 BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(ip_pool_index_test_suite)
+
+IPPoolIndex make_index(const IPPool& ip_pool) {
+    PackedIPPool packed_pool;
+    for (const auto& ip : ip_pool) {
+        packed_pool.push_back(pack_ip(ip));
+    }
+    return IPPoolIndex(std::move(packed_pool));
+}
+
+BOOST_AUTO_TEST_CASE(test_index_octet) {
+    IPPool ip_pool{{46, 70, 113, 73},
+                    {1, 1, 1, 1},
+                    {46, 71, 70, 39},
+                    {179, 210, 145, 4},
+                    {46, 70, 225, 39},
+                    {47, 70, 70, 70},
+                    {46, 7, 123, 70},
+    };
+    auto index = make_index(ip_pool);
+    BOOST_CHECK(index.size() == ip_pool.size());
+    {
+        IPPool expected{{46, 71, 70, 39},
+                        {46, 70, 225, 39},
+                        {46, 70, 113, 73},
+                        {46, 7, 123, 70},
+        };
+        BOOST_CHECK(index.select(index.octet(0, 46)) == expected);
+    }
+    {
+        IPPool expected{{47, 70, 70, 70},
+                        {46, 70, 225, 39},
+                        {46, 70, 113, 73},
+        };
+        BOOST_CHECK(index.select(index.octet(1, 70)) == expected);
+    }
+    {
+        IPPool expected{{46, 70, 225, 39},
+                        {46, 70, 113, 73},
+        };
+        BOOST_CHECK(index.select(index_and(index.octet(0, 46), index.octet(1, 70))) == expected);
+    }
+    {
+        IPPool expected{{47, 70, 70, 70},
+                        {46, 71, 70, 39},
+                        {46, 70, 225, 39},
+                        {46, 70, 113, 73},
+                        {46, 7, 123, 70},
+                        {1, 1, 1, 1},
+        };
+        BOOST_CHECK(index.select(index_or(index.any_octet(70), index.octet(3, 1))) == expected);
+    }
+    BOOST_CHECK(index.octet(2, 0).size() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_index_any_octet) {
+    IPPool ip_pool{{179, 210, 145, 4},
+                    {46, 46, 46, 46},
+                    {1, 46, 1, 1},
+                    {4, 6, 1, 1},
+                    {1, 1, 1, 46},
+    };
+    auto index = make_index(ip_pool);
+    IPPool expected{{46, 46, 46, 46},
+                    {1, 46, 1, 1},
+                    {1, 1, 1, 46},
+    };
+    BOOST_CHECK(index.select(index.any_octet(46)) == expected);
+    BOOST_CHECK(index.select(index.any_octet(46)) == ip_filter_copy_any(index.select(index.cidr({}, 0)), 46));
+}
+
+BOOST_AUTO_TEST_CASE(test_index_cidr) {
+    IPPool ip_pool{{10, 0, 0, 1},
+                    {10, 0, 255, 255},
+                    {10, 1, 0, 0},
+                    {9, 255, 255, 255},
+                    {192, 168, 1, 1},
+    };
+    auto index = make_index(ip_pool);
+    {
+        IPPool expected{{10, 0, 255, 255},
+                        {10, 0, 0, 1},
+        };
+        BOOST_CHECK(index.select(index.cidr({10, 0, 1, 2}, 16)) == expected);
+    }
+    BOOST_CHECK(index.cidr({10, 0, 0, 0}, 8).size() == 3);
+    BOOST_CHECK(index.cidr({}, 0).size() == 5);
+    BOOST_CHECK(index.cidr({192, 168, 1, 1}, 32).size() == 1);
+    BOOST_CHECK(index.cidr({192, 168, 1, 2}, 32).empty());
+    BOOST_CHECK_THROW(index.cidr({}, 33), invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
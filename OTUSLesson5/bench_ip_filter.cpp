@@ -0,0 +1,62 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <streambuf>
+
+#include "ip_filter.h"
+#include "ip_filter_views.h"
+
+using namespace std;
+
+namespace {
+
+/// discards everything, so only filtering and formatting are measured
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+template <typename F>
+double measure(F f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+// bench_ip_filter [pool_size], default pool size is 100M
+int main(int argc, char const *argv[]) {
+    size_t pool_size = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100'000'000;
+    IPPool ip_pool(pool_size);
+    mt19937 gen(42);
+    uniform_int_distribution<int> dist(0, 255);
+    for (auto& ip : ip_pool) {
+        for (auto& ip_part : ip) {
+            ip_part = static_cast<IPPart>(dist(gen));
+        }
+    }
+
+    NullBuffer null_buffer;
+    ostream out(&null_buffer);
+    auto pred = filter_cidr({46, 0, 0, 0}, 8) | filter_octet(1, 70) | filter_any(46);
+
+    double copy_time = measure([&]{
+        IPPool res;
+        copy_if(ip_pool.begin(), ip_pool.end(), back_inserter(res), pred);
+        out << res << '\n';
+    });
+    double lazy_time = measure([&]{
+        write_ips(ip_pool | pred, out);
+    });
+    double parallel_time = measure([&]{
+        parallel_filter_write(ip_pool, pred, out);
+    });
+    cout << "copy + output:     " << copy_time << " s\n";
+    cout << "lazy views:        " << lazy_time << " s\n";
+    cout << "parallel chunks:   " << parallel_time << " s (" << thread::hardware_concurrency()
+         << " threads)\n";
+    return 0;
+}
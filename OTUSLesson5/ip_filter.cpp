@@ -1,6 +1,8 @@
 #include "ip_filter.h"
 
 #include <algorithm>
+#include <charconv>
+#include <stdexcept>
 #include <tuple>
 
 #include "str_utils.h"
@@ -60,9 +62,15 @@ std::ostream& operator<<(std::ostream& out, const IPPool& ip_pool) {
     return out;
 }
 
-auto ip_filter_any(const IPPool& ip_pool, IPPart value) {
-    return ip_pool | ranges::view::filter([value](const IPAddress& ip) {
-           return is_any_part(ip, value);
-       }
-    );
+void append_ip_line(std::string& out, const IPAddress& ip_address) {
+    char buffer[4 * IP_SIZE];
+    char* p = buffer;
+    for (std::size_t i = 0; i < IP_SIZE; ++i) {
+        if (i != 0) {
+            *p++ = '.';
+        }
+        p = std::to_chars(p, buffer + sizeof(buffer), int(ip_address[i])).ptr;
+    }
+    *p++ = '\n';
+    out.append(buffer, p);
 }
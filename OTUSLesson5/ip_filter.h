@@ -19,6 +19,8 @@ constexpr std::size_t IP_SIZE = 4u;
 using IPAddress = std::array<IPPart, IP_SIZE>;
 IPAddress parse_ip(std::string_view ip_str);
 std::ostream& operator<<(std::ostream& out, const IPAddress& ip_address);
+/// appends "a.b.c.d\n" to out without ostream
+void append_ip_line(std::string& out, const IPAddress& ip_address);
 
 // ip-address pool
 using IPPool = std::vector<IPAddress>;
@@ -41,7 +43,12 @@ inline bool is_any_part(const IPAddress& ip, IPPart value) {
     );
 }
 
-auto ip_filter_any(const IPPool& ip_pool, IPPart value);
+inline auto ip_filter_any(const IPPool& ip_pool, IPPart value) {
+    return ip_pool | ranges::view::filter([value](const IPAddress& ip) {
+           return is_any_part(ip, value);
+       }
+    );
+}
 
 
 
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <range/v3/all.hpp>
+
+#include "ip_filter.h"
+
+// ip-address predicates
+
+/// ip_address[part_num] == value
+struct OctetEqual {
+    std::size_t part_num = 0;
+    IPPart value = 0;
+    bool operator()(const IPAddress& ip_address) const {
+        return ip_address[part_num] == value;
+    }
+};
+
+/// any ip-part == value
+struct AnyOctet {
+    IPPart value = 0;
+    bool operator()(const IPAddress& ip_address) const {
+        return is_any_part(ip_address, value);
+    }
+};
+
+/// ip-address is in subnet net/prefix_len, e.g. 46.70.0.0/16
+struct CidrMatch {
+    IPAddress net{};
+    unsigned prefix_len = 0;
+    bool operator()(const IPAddress& ip_address) const {
+        if (prefix_len == 0) return true;
+        std::uint32_t mask = prefix_len >= 32 ? ~0u : ~0u << (32u - prefix_len);
+        return (to_uint(ip_address) & mask) == (to_uint(net) & mask);
+    }
+private:
+    static std::uint32_t to_uint(const IPAddress& ip_address) {
+        std::uint32_t res = 0;
+        for (auto ip_part : ip_address) {
+            res = (res << 8) | ip_part;
+        }
+        return res;
+    }
+};
+
+/// conjunction of predicates
+template <typename ... Preds>
+struct AllOf {
+    std::tuple<Preds...> preds;
+    bool operator()(const IPAddress& ip_address) const {
+        return std::apply([&ip_address](const auto& ... p) {
+            return (p(ip_address) && ...);
+        }, preds);
+    }
+};
+
+/// disjunction of predicates
+template <typename ... Preds>
+struct AnyOf {
+    std::tuple<Preds...> preds;
+    bool operator()(const IPAddress& ip_address) const {
+        return std::apply([&ip_address](const auto& ... p) {
+            return (p(ip_address) || ...);
+        }, preds);
+    }
+};
+
+template <typename ... Preds>
+AllOf<Preds...> all_of(Preds ... preds) {
+    return {std::make_tuple(std::move(preds)...)};
+}
+
+template <typename ... Preds>
+AnyOf<Preds...> any_of(Preds ... preds) {
+    return {std::make_tuple(std::move(preds)...)};
+}
+
+/**
+ * Composable ip-address filter.
+ * Filters are chained with | into one predicate: filter_octet(0, 46) | filter_octet(1, 70).
+ * Applied to a range it gives a lazy view: ip_pool | filter_any(46),
+ * the same filter can be passed to parallel_filter_write.
+ */
+template <typename Pred>
+struct IPFilter {
+    Pred pred;
+    bool operator()(const IPAddress& ip_address) const {
+        return pred(ip_address);
+    }
+};
+
+template <typename T>
+struct is_ip_filter : std::false_type {};
+
+template <typename Pred>
+struct is_ip_filter<IPFilter<Pred>> : std::true_type {};
+
+template <typename Pred>
+IPFilter<Pred> make_ip_filter(Pred pred) {
+    return {std::move(pred)};
+}
+
+/// both filters must match
+template <typename Lhs, typename Rhs>
+auto operator|(IPFilter<Lhs> lhs, IPFilter<Rhs> rhs) {
+    return make_ip_filter(all_of(std::move(lhs.pred), std::move(rhs.pred)));
+}
+
+/// lazy view of range elements matched by filter
+template <typename Range, typename Pred,
+          typename = std::enable_if_t<!is_ip_filter<std::decay_t<Range>>::value>>
+auto operator|(Range&& range, IPFilter<Pred> filter) {
+    return std::forward<Range>(range) | ranges::view::filter(std::move(filter.pred));
+}
+
+inline auto filter_octet(std::size_t part_num, IPPart value) {
+    return make_ip_filter(OctetEqual{part_num, value});
+}
+
+inline auto filter_any(IPPart value) {
+    return make_ip_filter(AnyOctet{value});
+}
+
+inline auto filter_cidr(const IPAddress& net, unsigned prefix_len) {
+    return make_ip_filter(CidrMatch{net, prefix_len});
+}
+
+/// streams range of ip-addresses to out, one per line
+template <typename Range>
+void write_ips(Range&& range, std::ostream& out) {
+    ranges::for_each(std::forward<Range>(range), [&out](const IPAddress& ip) {
+        out << ip << '\n';
+    });
+}
+
+/**
+ * Evaluates pred (e.g. a chain of ip filters) over ip_pool in parallel chunks and streams matched ip-addresses to out
+ * in the original order. Only formatted text of chunks in flight is kept in memory,
+ * no IPPool copies are made.
+ */
+template <typename Pred>
+void parallel_filter_write(const IPPool& ip_pool, Pred pred, std::ostream& out,
+        std::size_t threads_count = std::thread::hardware_concurrency())
+{
+    if (threads_count == 0) {
+        threads_count = 1;
+    }
+    const std::size_t chunks_count = threads_count * 4;
+    const std::size_t chunk_size = (ip_pool.size() + chunks_count - 1) / chunks_count;
+    if (chunk_size == 0) return;
+
+    auto process_chunk = [&ip_pool, &pred](std::size_t first, std::size_t last) {
+        std::string res;
+        for (auto i = first; i != last; ++i) {
+            if (pred(ip_pool[i])) {
+                append_ip_line(res, ip_pool[i]);
+            }
+        }
+        return res;
+    };
+
+    std::deque<std::future<std::string>> in_flight;
+    std::size_t next = 0;
+    auto launch_next = [&]() {
+        auto last = std::min(next + chunk_size, ip_pool.size());
+        in_flight.push_back(std::async(std::launch::async, process_chunk, next, last));
+        next = last;
+    };
+    while (next != ip_pool.size() && in_flight.size() < threads_count) {
+        launch_next();
+    }
+    while (!in_flight.empty()) {
+        auto text = in_flight.front().get();
+        in_flight.pop_front();
+        if (next != ip_pool.size()) {
+            launch_next();
+        }
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+}
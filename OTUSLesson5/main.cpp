@@ -2,6 +2,7 @@
 #include <range/v3/all.hpp>
 
 #include "ip_filter.h"
+#include "ip_filter_views.h"
 
 int main([[maybe_unused]]int argc, [[maybe_unused]]char const *argv[])
 {
@@ -13,23 +14,13 @@ int main([[maybe_unused]]int argc, [[maybe_unused]]char const *argv[])
         cout << ip_pool << endl;
 
         // filter: first byte == 1 and output
-        ranges::for_each(ip_pool | ranges::view::filter([value=1](const auto& ip){ return ip[0] == value;}),
-                [](const auto& ip){cout << ip << '\n';});
+        parallel_filter_write(ip_pool, filter_octet(0, 1), cout);
 
         // filter: fb==46, sb==70 and output
-        ranges::for_each(ip_pool
-            | ranges::view::filter([value=46](const auto& ip){ return ip[0] == value;})
-            | ranges::view::filter([value=70](const auto& ip){ return ip[1] == value;}),
-        [](const auto& ip){cout << ip << '\n';}
-        );
+        parallel_filter_write(ip_pool, filter_octet(0, 46) | filter_octet(1, 70), cout);
 
         // filter: any_byte == 46
-        ranges::for_each(ip_pool
-            | ranges::view::filter([value=46](const IPAddress& ip) {
-                return is_any_part(ip, value);
-            }),
-            [](const auto& ip){cout << ip << '\n';}
-        );
+        parallel_filter_write(ip_pool, filter_any(46), cout);
     }
     catch(const std::exception &e)
     {
@@ -2,6 +2,7 @@
 
 #include <optional>
 #include <charconv>
+#include <stdexcept>
 
 std::vector<std::string> split(const std::string& str, char d)
 {
@@ -5,6 +5,7 @@
 
 #include "ip_filter.h"
 #include "str_utils.h"
+#include "ip_filter_views.h"
 
 using namespace std;
 
@@ -286,3 +287,70 @@ BOOST_AUTO_TEST_CASE(test_ip_filter_any) {
 }
 
 BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(ip_filter_views_test_suite)
+
+BOOST_AUTO_TEST_CASE(test_predicates) {
+    IPAddress ip{46, 70, 225, 39};
+    BOOST_CHECK((OctetEqual{0, 46}(ip)));
+    BOOST_CHECK((!OctetEqual{1, 46}(ip)));
+    BOOST_CHECK(AnyOctet{39}(ip));
+    BOOST_CHECK(!AnyOctet{1}(ip));
+    BOOST_CHECK((CidrMatch{{46, 70, 0, 0}, 16}(ip)));
+    BOOST_CHECK((CidrMatch{{46, 70, 224, 0}, 23}(ip)));
+    BOOST_CHECK((!CidrMatch{{46, 70, 224, 0}, 24}(ip)));
+    BOOST_CHECK((CidrMatch{{0, 0, 0, 0}, 0}(ip)));
+    BOOST_CHECK((CidrMatch{{46, 70, 225, 39}, 32}(ip)));
+    BOOST_CHECK((all_of(OctetEqual{0, 46}, OctetEqual{1, 70})(ip)));
+    BOOST_CHECK((!all_of(OctetEqual{0, 46}, OctetEqual{1, 71})(ip)));
+    BOOST_CHECK((any_of(OctetEqual{0, 1}, AnyOctet{225})(ip)));
+}
+
+BOOST_AUTO_TEST_CASE(test_lazy_filters) {
+    IPPool ip_pool{{179, 210, 145, 4},
+                    {47, 70, 70, 70},
+                    {46, 71, 70, 39},
+                    {46, 70, 225, 39},
+                    {46, 70, 113, 73},
+                    {46, 7, 123, 70},
+                    {1, 1, 1, 1},
+    };
+    stringstream out;
+    write_ips(ip_pool | filter_octet(0, 46) | filter_octet(1, 70), out);
+    BOOST_CHECK(out.str() == "46.70.225.39\n46.70.113.73\n");
+    stringstream out_cidr;
+    write_ips(ip_pool | filter_cidr({46, 64, 0, 0}, 10) | filter_any(39), out_cidr);
+    BOOST_CHECK(out_cidr.str() == "46.71.70.39\n46.70.225.39\n");
+    stringstream out_chain;
+    auto filter = filter_octet(0, 46) | filter_octet(1, 70) | filter_any(39);
+    BOOST_CHECK(filter(IPAddress{46, 70, 225, 39}));
+    BOOST_CHECK(!filter(IPAddress{46, 71, 70, 39}));
+    write_ips(ip_pool | filter, out_chain);
+    BOOST_CHECK(out_chain.str() == "46.70.225.39\n");
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_filter_write) {
+    IPPool ip_pool;
+    for (int i = 0; i < 1000; ++i) {
+        ip_pool.push_back({IPPart(i % 256), IPPart(i / 256), 1, 2});
+    }
+    for (std::size_t threads : {1u, 2u, 3u, 8u}) {
+        stringstream expected;
+        write_ips(ip_pool | filter_any(2), expected);
+        stringstream out;
+        parallel_filter_write(ip_pool, AnyOctet{2}, out, threads);
+        BOOST_CHECK(out.str() == expected.str());
+        auto filter = filter_cidr({0, 0, 0, 0}, 1) | filter_octet(1, 2);
+        stringstream expected_chain;
+        write_ips(ip_pool | filter, expected_chain);
+        stringstream out_chain;
+        parallel_filter_write(ip_pool, filter, out_chain, threads);
+        BOOST_CHECK(!out_chain.str().empty());
+        BOOST_CHECK(out_chain.str() == expected_chain.str());
+    }
+    stringstream empty_out;
+    parallel_filter_write(IPPool{}, AnyOctet{2}, empty_out, 4);
+    BOOST_CHECK(empty_out.str().empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()